@@ -0,0 +1,79 @@
+#include "bench_numbers.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <vector>
+
+// Размеры операндов в значащих словах задаются аргументом бенчмарка (1, 8, 32, 64).
+// bytes_copied - см. set_bytes_copied в bench_numbers.h.
+// Разбор и печать десятичной записи - в conversion_bench.cpp.
+
+namespace {
+
+template <typename Op>
+void run_binary(benchmark::State& state, size_t lhs_parts, size_t rhs_parts, size_t bytes_copied, Op op) {
+    std::vector<uint2022_t> lhs = make_numbers(lhs_parts, 1);
+    std::vector<uint2022_t> rhs = make_numbers(rhs_parts, 2);
+    size_t i = 0;
+    for (auto _ : state) {
+        size_t k = i++ % kBenchCount;
+        benchmark::DoNotOptimize(op(lhs[k], rhs[k]));
+    }
+    set_bytes_copied(state, bytes_copied);
+}
+
+// operator+ и operator- копируют lhs в результат, operator* заполняет новый результат
+void BM_Add(benchmark::State& state) {
+    run_binary(state, state.range(0), state.range(0), kNumberBytes, [](const uint2022_t& a, const uint2022_t& b) { return a + b; });
+}
+
+void BM_Sub(benchmark::State& state) {
+    run_binary(state, state.range(0), state.range(0), kNumberBytes, [](const uint2022_t& a, const uint2022_t& b) { return b - a; });
+}
+
+void BM_Mul(benchmark::State& state) {
+    run_binary(state, state.range(0), state.range(0), kNumberBytes, [](const uint2022_t& a, const uint2022_t& b) { return a * b; });
+}
+
+// Делитель вдвое короче делимого, чтобы частное было непустым. divmod заполняет частное
+// и остаток, а для делителя длиннее двух слов еще и нормализованные копии операндов
+// (kParts и kParts + 1 слов)
+void BM_Div(benchmark::State& state) {
+    size_t parts = state.range(0);
+    size_t divisor_parts = std::max<size_t>(1, parts / 2);
+    size_t normalized = divisor_parts > 2 ? (2 * uint2022_t::kParts + 1) * sizeof(uint32_t) : 0;
+    run_binary(state, parts, divisor_parts, 2 * kNumberBytes + normalized, [](const uint2022_t& a, const uint2022_t& b) { return a / b; });
+}
+
+// Накопление на месте, без временных чисел
+void BM_AddAssign(benchmark::State& state) {
+    std::vector<uint2022_t> values = make_numbers(state.range(0), 1);
+    uint2022_t acc;
+    size_t i = 0;
+    for (auto _ : state) {
+        acc += values[i++ % kBenchCount];
+        benchmark::DoNotOptimize(acc);
+    }
+    set_bytes_copied(state, 0);
+}
+
+void BM_MulAccumulate(benchmark::State& state) {
+    std::vector<uint2022_t> lhs = make_numbers(state.range(0), 1);
+    std::vector<uint2022_t> rhs = make_numbers(state.range(0), 2);
+    uint2022_t acc;
+    size_t i = 0;
+    for (auto _ : state) {
+        size_t k = i++ % kBenchCount;
+        acc += mul(lhs[k], rhs[k]);
+        benchmark::DoNotOptimize(acc);
+    }
+    set_bytes_copied(state, 0);
+}
+
+} // namespace
+
+BENCHMARK(BM_Add)->Arg(1)->Arg(8)->Arg(32)->Arg(64);
+BENCHMARK(BM_Sub)->Arg(1)->Arg(8)->Arg(32)->Arg(64);
+BENCHMARK(BM_Mul)->Arg(1)->Arg(8)->Arg(32)->Arg(64);
+BENCHMARK(BM_Div)->Arg(1)->Arg(8)->Arg(32)->Arg(64);
+BENCHMARK(BM_AddAssign)->Arg(1)->Arg(8)->Arg(32)->Arg(64);
+BENCHMARK(BM_MulAccumulate)->Arg(1)->Arg(8)->Arg(32)->Arg(64);
@@ -0,0 +1,31 @@
+#pragma once
+#include <lib/number.h>
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+// Сколько разных операндов перебирает бенчмарк, чтобы не мерить одно и то же число
+inline constexpr size_t kBenchCount = 64;
+
+// Числа с заданным количеством значащих слов; старшее слово всегда ненулевое
+inline std::vector<uint2022_t> make_numbers(size_t parts, uint32_t seed = 42, size_t count = kBenchCount) {
+    std::mt19937 rng(seed);
+    std::vector<uint2022_t> values(count);
+    for (uint2022_t& value : values) {
+        for (size_t i = 0; i < parts; i++) {
+            value.parts[i] = rng() | (i + 1 == parts ? 0x80000000 : 0);
+        }
+    }
+    return values;
+}
+
+// Счетчик bytes_copied - сколько байт занимают числа, которые операция создает и заполняет
+// целиком: результат, рабочие копии операндов. uint_t - простой агрегат без своих
+// конструкторов копирования, перехватить копии нечем, поэтому число временных объектов
+// каждой операции берется из ее кода в lib/number.h и передается сюда
+inline void set_bytes_copied(benchmark::State& state, size_t bytes) {
+    state.counters["bytes_copied"] = benchmark::Counter(static_cast<double>(bytes));
+}
+
+// Байт в одном uint2022_t
+inline constexpr size_t kNumberBytes = sizeof(uint2022_t);
@@ -0,0 +1,95 @@
+#include "bench_numbers.h"
+#include <lib/serialize.h>
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> to_decimal(const std::vector<uint2022_t>& values) {
+    std::vector<std::string> result;
+    for (const uint2022_t& value : values) {
+        std::ostringstream stream;
+        stream << value;
+        result.push_back(stream.str());
+    }
+    return result;
+}
+
+void BM_FromDecimal(benchmark::State& state) {
+    std::vector<std::string> text = to_decimal(make_numbers(state.range(0)));
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(from_string(text[i++ % text.size()].c_str()));
+    }
+    state.SetBytesProcessed(state.iterations() * text[0].size());
+    // from_string заполняет новый результат
+    set_bytes_copied(state, kNumberBytes);
+}
+
+void BM_ToDecimal(benchmark::State& state) {
+    std::vector<uint2022_t> values = make_numbers(state.range(0));
+    std::ostringstream stream;
+    size_t i = 0;
+    for (auto _ : state) {
+        stream.str(std::string());
+        stream << values[i++ % values.size()];
+        benchmark::DoNotOptimize(stream);
+    }
+    // operator<< делит рабочую копию числа
+    set_bytes_copied(state, kNumberBytes);
+}
+
+void BM_ToHex(benchmark::State& state) {
+    std::vector<uint2022_t> values = make_numbers(state.range(0));
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(to_hex(values[i++ % values.size()]));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * 8);
+}
+
+void BM_FromHex(benchmark::State& state) {
+    std::vector<std::string> text;
+    for (const uint2022_t& value : make_numbers(state.range(0))) {
+        text.push_back(to_hex(value));
+    }
+    uint2022_t parsed;
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(from_hex(text[i++ % text.size()], parsed));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * 8);
+}
+
+void BM_BinaryRoundTrip(benchmark::State& state) {
+    std::vector<uint2022_t> values = make_numbers(state.range(0));
+    uint8_t bytes[binary_size<2022>];
+    size_t i = 0;
+    for (auto _ : state) {
+        to_bytes(values[i++ % values.size()], bytes);
+        benchmark::DoNotOptimize(from_bytes<2022>(bytes));
+    }
+    state.SetBytesProcessed(state.iterations() * 2 * binary_size<2022>);
+}
+
+void BM_CompactRoundTrip(benchmark::State& state) {
+    std::vector<uint2022_t> values = make_numbers(state.range(0));
+    uint8_t buffer[compact_max_size<2022>];
+    uint2022_t decoded;
+    size_t i = 0;
+    for (auto _ : state) {
+        size_t size = encode_compact(values[i++ % values.size()], buffer);
+        benchmark::DoNotOptimize(decode_compact(buffer, size, decoded));
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_FromDecimal)->Arg(1)->Arg(8)->Arg(32)->Arg(64);
+BENCHMARK(BM_ToDecimal)->Arg(1)->Arg(8)->Arg(32)->Arg(64);
+BENCHMARK(BM_ToHex)->Arg(1)->Arg(8)->Arg(32)->Arg(64);
+BENCHMARK(BM_FromHex)->Arg(1)->Arg(8)->Arg(32)->Arg(64);
+BENCHMARK(BM_BinaryRoundTrip)->Arg(1)->Arg(8)->Arg(32)->Arg(64);
+BENCHMARK(BM_CompactRoundTrip)->Arg(1)->Arg(8)->Arg(32)->Arg(64);
@@ -0,0 +1,311 @@
+#pragma once
+#include "number.h"
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Набор из size() чисел uint_t<Bits> в раскладке structure-of-arrays:
+// слово i всех чисел лежит подряд, limbs_[i * stride_ + lane].
+// Операции идут сразу по всем числам, перенос распространяется по векторам.
+template <size_t Bits>
+class uint_batch {
+public:
+    static constexpr size_t kParts = uint_t<Bits>::kParts;
+    // Число дорожек выравнивается до ширины AVX-512 для 32-битных слов
+    static constexpr size_t kLaneAlign = 16;
+
+    uint_batch() = default;
+
+    explicit uint_batch(size_t size)
+        : size_(size), stride_((size + kLaneAlign - 1) / kLaneAlign * kLaneAlign), limbs_(kParts * stride_, 0) {
+    }
+
+    uint_batch(const uint_t<Bits>* values, size_t count) : uint_batch(count) {
+        load(values, count);
+    }
+
+    size_t size() const { return size_; }
+    size_t stride() const { return stride_; }
+
+    uint32_t* limb(size_t i) { return limbs_.data() + i * stride_; }
+    const uint32_t* limb(size_t i) const { return limbs_.data() + i * stride_; }
+
+    uint_t<Bits> get(size_t lane) const {
+        uint_t<Bits> value;
+        for (size_t i = 0; i < kParts; i++) {
+            value.parts[i] = limb(i)[lane];
+        }
+        return value;
+    }
+
+    void set(size_t lane, const uint_t<Bits>& value) {
+        for (size_t i = 0; i < kParts; i++) {
+            limb(i)[lane] = value.parts[i];
+        }
+    }
+
+    // Транспонирование блоками: по 16 чисел за раз, чтобы строки limbs оставались в кэше
+    void load(const uint_t<Bits>* values, size_t count) {
+        for (size_t base = 0; base < count; base += kLaneAlign) {
+            size_t block = std::min(kLaneAlign, count - base);
+            for (size_t i = 0; i < kParts; i++) {
+                uint32_t* row = limb(i) + base;
+                for (size_t lane = 0; lane < block; lane++) {
+                    row[lane] = values[base + lane].parts[i];
+                }
+            }
+        }
+    }
+
+    void store(uint_t<Bits>* values) const {
+        for (size_t base = 0; base < size_; base += kLaneAlign) {
+            size_t block = std::min(kLaneAlign, size_ - base);
+            for (size_t i = 0; i < kParts; i++) {
+                const uint32_t* row = limb(i) + base;
+                for (size_t lane = 0; lane < block; lane++) {
+                    values[base + lane].parts[i] = row[lane];
+                }
+            }
+        }
+    }
+
+    std::vector<uint_t<Bits>> to_vector() const {
+        std::vector<uint_t<Bits>> values(size_);
+        store(values.data());
+        return values;
+    }
+
+    // Количество слов, в которых хотя бы у одного числа есть ненулевое значение
+    size_t active_parts() const {
+        size_t size = kParts;
+        while (size > 0) {
+            const uint32_t* row = limb(size - 1);
+            uint32_t any = 0;
+            for (size_t lane = 0; lane < stride_; lane++) {
+                any |= row[lane];
+            }
+            if (any != 0) break;
+            size--;
+        }
+        return size;
+    }
+
+private:
+    size_t size_ = 0;
+    size_t stride_ = 0;
+    std::vector<uint32_t> limbs_;
+};
+
+using uint2022_batch = uint_batch<2022>;
+
+namespace number_detail {
+
+// Ширина блока дорожек для скалярного пути: переносы блока лежат в массиве на стеке,
+// а внутренний цикл по дорожкам векторизуется компилятором
+inline constexpr size_t kBatchBlock = 64;
+
+// Пакеты разной длины - ошибка вызывающего, как и выход за границы std::vector
+template <size_t Bits>
+void batch_resize_like(uint_batch<Bits>& out, const uint_batch<Bits>& lhs, [[maybe_unused]] const uint_batch<Bits>& rhs) {
+    assert(lhs.size() == rhs.size() && "uint_batch operands must have the same size");
+    if (out.size() != lhs.size()) {
+        out = uint_batch<Bits>(lhs.size());
+    }
+}
+
+} // namespace number_detail
+
+// out[k] = lhs[k] + rhs[k]; out может совпадать с одним из аргументов
+template <size_t Bits>
+void add(const uint_batch<Bits>& lhs, const uint_batch<Bits>& rhs, uint_batch<Bits>& out) {
+    constexpr size_t kParts = uint_t<Bits>::kParts;
+    number_detail::batch_resize_like(out, lhs, rhs);
+    const size_t stride = lhs.stride();
+    size_t lane = 0;
+#if defined(__AVX512F__)
+    for (; lane < stride; lane += 16) {
+        __mmask16 carry = 0;
+        for (size_t i = 0; i < kParts; i++) {
+            __m512i a = _mm512_loadu_si512(lhs.limb(i) + lane);
+            __m512i b = _mm512_loadu_si512(rhs.limb(i) + lane);
+            __m512i sum = _mm512_add_epi32(a, b);
+            __mmask16 overflow = _mm512_cmplt_epu32_mask(sum, a);
+            sum = _mm512_mask_add_epi32(sum, carry, sum, _mm512_set1_epi32(1));
+            carry = overflow | _mm512_mask_cmpeq_epi32_mask(carry, sum, _mm512_setzero_si512());
+            _mm512_storeu_si512(out.limb(i) + lane, sum);
+        }
+    }
+#elif defined(__AVX2__)
+    for (; lane + 8 <= stride; lane += 8) {
+        __m256i carry = _mm256_setzero_si256(); // маска: -1 там, где есть перенос
+        for (size_t i = 0; i < kParts; i++) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs.limb(i) + lane));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs.limb(i) + lane));
+            __m256i sum = _mm256_add_epi32(a, b);
+            __m256i overflow = _mm256_xor_si256(_mm256_cmpeq_epi32(_mm256_max_epu32(sum, a), sum), _mm256_set1_epi32(-1));
+            sum = _mm256_sub_epi32(sum, carry);
+            carry = _mm256_or_si256(overflow, _mm256_and_si256(carry, _mm256_cmpeq_epi32(sum, _mm256_setzero_si256())));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.limb(i) + lane), sum);
+        }
+    }
+#endif
+    for (; lane < stride; lane += number_detail::kBatchBlock) {
+        size_t block = std::min(number_detail::kBatchBlock, stride - lane);
+        uint32_t carry[number_detail::kBatchBlock] = {};
+        for (size_t i = 0; i < kParts; i++) {
+            const uint32_t* a = lhs.limb(i) + lane;
+            const uint32_t* b = rhs.limb(i) + lane;
+            uint32_t* dst = out.limb(i) + lane;
+            for (size_t k = 0; k < block; k++) {
+                uint64_t sum = (uint64_t)a[k] + b[k] + carry[k];
+                dst[k] = static_cast<uint32_t>(sum);
+                carry[k] = static_cast<uint32_t>(sum >> 32);
+            }
+        }
+    }
+}
+
+// out[k] = lhs[k] - rhs[k]; out может совпадать с одним из аргументов
+template <size_t Bits>
+void sub(const uint_batch<Bits>& lhs, const uint_batch<Bits>& rhs, uint_batch<Bits>& out) {
+    constexpr size_t kParts = uint_t<Bits>::kParts;
+    number_detail::batch_resize_like(out, lhs, rhs);
+    const size_t stride = lhs.stride();
+    size_t lane = 0;
+#if defined(__AVX512F__)
+    for (; lane < stride; lane += 16) {
+        __mmask16 borrow = 0;
+        for (size_t i = 0; i < kParts; i++) {
+            __m512i a = _mm512_loadu_si512(lhs.limb(i) + lane);
+            __m512i b = _mm512_loadu_si512(rhs.limb(i) + lane);
+            __m512i diff = _mm512_sub_epi32(a, b);
+            __mmask16 underflow = _mm512_cmplt_epu32_mask(a, b);
+            underflow |= _mm512_mask_cmpeq_epi32_mask(borrow, diff, _mm512_setzero_si512());
+            diff = _mm512_mask_sub_epi32(diff, borrow, diff, _mm512_set1_epi32(1));
+            borrow = underflow;
+            _mm512_storeu_si512(out.limb(i) + lane, diff);
+        }
+    }
+#elif defined(__AVX2__)
+    for (; lane + 8 <= stride; lane += 8) {
+        __m256i borrow = _mm256_setzero_si256();
+        for (size_t i = 0; i < kParts; i++) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs.limb(i) + lane));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs.limb(i) + lane));
+            __m256i diff = _mm256_sub_epi32(a, b);
+            // a < b  <=>  max(a, b) != a
+            __m256i underflow = _mm256_xor_si256(_mm256_cmpeq_epi32(_mm256_max_epu32(a, b), a), _mm256_set1_epi32(-1));
+            underflow = _mm256_or_si256(underflow, _mm256_and_si256(borrow, _mm256_cmpeq_epi32(diff, _mm256_setzero_si256())));
+            diff = _mm256_add_epi32(diff, borrow);
+            borrow = underflow;
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.limb(i) + lane), diff);
+        }
+    }
+#endif
+    for (; lane < stride; lane += number_detail::kBatchBlock) {
+        size_t block = std::min(number_detail::kBatchBlock, stride - lane);
+        uint32_t borrow[number_detail::kBatchBlock] = {};
+        for (size_t i = 0; i < kParts; i++) {
+            const uint32_t* a = lhs.limb(i) + lane;
+            const uint32_t* b = rhs.limb(i) + lane;
+            uint32_t* dst = out.limb(i) + lane;
+            for (size_t k = 0; k < block; k++) {
+                uint64_t diff = (uint64_t)a[k] - b[k] - borrow[k];
+                dst[k] = static_cast<uint32_t>(diff);
+                borrow[k] = static_cast<uint32_t>(diff >> 63);
+            }
+        }
+    }
+}
+
+// out[k] = lhs[k] * rhs[k] (младшие kParts слов). Умножение по столбцам: столбец результата
+// копится в двух 64-битных суммах (младшие и старшие половины произведений), поэтому
+// перенос обрабатывается один раз на столбец, а не на каждое произведение
+template <size_t Bits>
+void mul(const uint_batch<Bits>& lhs, const uint_batch<Bits>& rhs, uint_batch<Bits>& out) {
+    constexpr size_t kParts = uint_t<Bits>::kParts;
+    if (&out == &lhs || &out == &rhs) {
+        uint_batch<Bits> result;
+        mul(lhs, rhs, result);
+        out = std::move(result);
+        return;
+    }
+    number_detail::batch_resize_like(out, lhs, rhs);
+    const size_t stride = lhs.stride();
+    const size_t lhs_size = lhs.active_parts();
+    const size_t rhs_size = rhs.active_parts();
+    const size_t columns = std::min(kParts, lhs_size + rhs_size);
+    for (size_t k = columns; k < kParts; k++) {
+        std::memset(out.limb(k), 0, stride * sizeof(uint32_t));
+    }
+    if (lhs_size == 0 || rhs_size == 0) {
+        for (size_t k = 0; k < columns; k++) {
+            std::memset(out.limb(k), 0, stride * sizeof(uint32_t));
+        }
+        return;
+    }
+
+    size_t lane = 0;
+#if defined(__AVX2__)
+    const __m256i low_mask = _mm256_set1_epi64x(0xFFFFFFFF);
+    for (; lane + 8 <= stride; lane += 8) {
+        // Четные и нечетные дорожки считаются отдельно в 64-битных элементах
+        __m256i carry_even = _mm256_setzero_si256();
+        __m256i carry_odd = _mm256_setzero_si256();
+        for (size_t k = 0; k < columns; k++) {
+            __m256i lo_even = carry_even;
+            __m256i lo_odd = carry_odd;
+            __m256i hi_even = _mm256_setzero_si256();
+            __m256i hi_odd = _mm256_setzero_si256();
+            size_t first = k + 1 > rhs_size ? k + 1 - rhs_size : 0;
+            size_t last = std::min(k, lhs_size - 1);
+            for (size_t i = first; i <= last; i++) {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs.limb(i) + lane));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs.limb(k - i) + lane));
+                __m256i even = _mm256_mul_epu32(a, b);
+                __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+                lo_even = _mm256_add_epi64(lo_even, _mm256_and_si256(even, low_mask));
+                hi_even = _mm256_add_epi64(hi_even, _mm256_srli_epi64(even, 32));
+                lo_odd = _mm256_add_epi64(lo_odd, _mm256_and_si256(odd, low_mask));
+                hi_odd = _mm256_add_epi64(hi_odd, _mm256_srli_epi64(odd, 32));
+            }
+            __m256i result = _mm256_or_si256(_mm256_and_si256(lo_even, low_mask), _mm256_slli_epi64(lo_odd, 32));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.limb(k) + lane), result);
+            carry_even = _mm256_add_epi64(_mm256_srli_epi64(lo_even, 32), hi_even);
+            carry_odd = _mm256_add_epi64(_mm256_srli_epi64(lo_odd, 32), hi_odd);
+        }
+    }
+#endif
+    for (; lane < stride; lane += number_detail::kBatchBlock) {
+        size_t block = std::min(number_detail::kBatchBlock, stride - lane);
+        uint64_t carry[number_detail::kBatchBlock] = {};
+        uint64_t lo[number_detail::kBatchBlock];
+        uint64_t hi[number_detail::kBatchBlock];
+        for (size_t k = 0; k < columns; k++) {
+            for (size_t t = 0; t < block; t++) {
+                lo[t] = carry[t];
+                hi[t] = 0;
+            }
+            size_t first = k + 1 > rhs_size ? k + 1 - rhs_size : 0;
+            size_t last = std::min(k, lhs_size - 1);
+            for (size_t i = first; i <= last; i++) {
+                const uint32_t* a = lhs.limb(i) + lane;
+                const uint32_t* b = rhs.limb(k - i) + lane;
+                for (size_t t = 0; t < block; t++) {
+                    uint64_t product = (uint64_t)a[t] * b[t];
+                    lo[t] += product & 0xFFFFFFFF;
+                    hi[t] += product >> 32;
+                }
+            }
+            uint32_t* dst = out.limb(k) + lane;
+            for (size_t t = 0; t < block; t++) {
+                dst[t] = static_cast<uint32_t>(lo[t]);
+                carry[t] = (lo[t] >> 32) + hi[t];
+            }
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <bit>
+#include <cinttypes>
+
+// Делитель до 64 бит с заранее посчитанной обратной величиной (Möller, Granlund,
+// "Improved division by invariant integers"). Слово - 32 бита, b = 2^32.
+// Делители до 32 бит делят по схеме 2/1 слова, 64-битные - по схеме 3/2.
+// После построения деление идет только умножениями и сложениями.
+class invariant_divisor {
+public:
+    // divisor > 0
+    explicit constexpr invariant_divisor(uint64_t divisor) : value_(divisor) {
+        if (divisor >> 32 == 0) {
+            shift_ = std::countl_zero(static_cast<uint32_t>(divisor));
+            d1_ = static_cast<uint32_t>(divisor) << shift_;
+            d0_ = 0;
+            v_ = reciprocal_word(d1_);
+            wide_ = false;
+        }
+        else {
+            shift_ = std::countl_zero(divisor);
+            uint64_t normalized = divisor << shift_;
+            d1_ = static_cast<uint32_t>(normalized >> 32);
+            d0_ = static_cast<uint32_t>(normalized);
+            v_ = reciprocal_pair(d1_, d0_);
+            wide_ = true;
+        }
+    }
+
+    constexpr uint64_t value() const { return value_; }
+
+    // Сдвиг, на который нормализован делитель (и должно быть сдвинуто делимое)
+    constexpr int shift() const { return shift_; }
+
+    constexpr bool wide() const { return wide_; }
+
+    // Нормализованный делитель; для узкого делителя старшая половина равна нулю
+    constexpr uint64_t normalized() const { return wide_ ? ((uint64_t)d1_ << 32) | d0_ : d1_; }
+
+    // Один шаг деления нормализованного делимого: remainder * b + word делится на делитель.
+    // remainder на входе меньше нормализованного делителя, на выходе - новый остаток
+    constexpr uint32_t step(uint64_t& remainder, uint32_t word) const {
+        if (!wide_) {
+            return divide_2by1(static_cast<uint32_t>(remainder), word, remainder);
+        }
+        return divide_3by2(static_cast<uint32_t>(remainder >> 32), static_cast<uint32_t>(remainder), word, remainder);
+    }
+
+private:
+    // floor((b^2 - 1) / d) - b для нормализованного d; единственное аппаратное деление
+    static constexpr uint32_t reciprocal_word(uint32_t d) {
+        return static_cast<uint32_t>(UINT64_MAX / d - (uint64_t(1) << 32));
+    }
+
+    // floor((b^3 - 1) / (d1, d0)) - b (алгоритм 6 из статьи)
+    static constexpr uint32_t reciprocal_pair(uint32_t d1, uint32_t d0) {
+        uint32_t v = reciprocal_word(d1);
+        uint32_t p = d1 * v;
+        p += d0;
+        if (p < d0) {
+            v--;
+            if (p >= d1) {
+                v--;
+                p -= d1;
+            }
+            p -= d1;
+        }
+        uint64_t t = (uint64_t)v * d0;
+        uint32_t t1 = static_cast<uint32_t>(t >> 32);
+        uint32_t t0 = static_cast<uint32_t>(t);
+        p += t1;
+        if (p < t1) {
+            v--;
+            if (((uint64_t)p << 32 | t0) >= ((uint64_t)d1 << 32 | d0)) {
+                v--;
+            }
+        }
+        return v;
+    }
+
+    // (u1, u0) / d1, u1 < d1 (алгоритм 4)
+    constexpr uint32_t divide_2by1(uint32_t u1, uint32_t u0, uint64_t& remainder) const {
+        uint64_t q = (uint64_t)v_ * u1 + (((uint64_t)u1 << 32) | u0);
+        uint32_t q1 = static_cast<uint32_t>(q >> 32) + 1;
+        uint32_t q0 = static_cast<uint32_t>(q);
+        uint32_t r = u0 - q1 * d1_;
+        if (r > q0) {
+            q1--;
+            r += d1_;
+        }
+        if (r >= d1_) {
+            q1++;
+            r -= d1_;
+        }
+        remainder = r;
+        return q1;
+    }
+
+    // (u2, u1, u0) / (d1, d0), (u2, u1) < (d1, d0) (алгоритм 5)
+    constexpr uint32_t divide_3by2(uint32_t u2, uint32_t u1, uint32_t u0, uint64_t& remainder) const {
+        const uint64_t d = ((uint64_t)d1_ << 32) | d0_;
+        uint64_t q = (uint64_t)v_ * u2 + (((uint64_t)u2 << 32) | u1);
+        uint32_t q1 = static_cast<uint32_t>(q >> 32);
+        uint32_t q0 = static_cast<uint32_t>(q);
+        uint32_t r1 = u1 - q1 * d1_;
+        uint64_t t = (uint64_t)d0_ * q1;
+        uint64_t r = ((((uint64_t)r1 << 32) | u0) - t) - d;
+        q1++;
+        if (static_cast<uint32_t>(r >> 32) >= q0) {
+            q1--;
+            r += d;
+        }
+        if (r >= d) {
+            q1++;
+            r -= d;
+        }
+        remainder = r;
+        return q1;
+    }
+
+    uint64_t value_;
+    uint32_t d1_ = 0;
+    uint32_t d0_ = 0;
+    uint32_t v_ = 0;
+    int shift_ = 0;
+    bool wide_ = false;
+};
@@ -0,0 +1,222 @@
+#pragma once
+#include "number.h"
+#include <iterator>
+
+// Модульная арифметика по нечетному модулю n в форме Монтгомери.
+// R = 2^(32 * s), где s - количество значащих слов модуля. Числа в форме
+// Монтгомери хранятся как x * R mod n, произведение multiply() обходится без деления.
+template <size_t Bits>
+class montgomery_context {
+public:
+    static constexpr size_t kParts = uint_t<Bits>::kParts;
+    // Окно для powmod: таблица из 2^(kWindow - 1) нечетных степеней
+    static constexpr int kWindow = 5;
+
+    // modulus должен быть нечетным и больше единицы
+    explicit constexpr montgomery_context(const uint_t<Bits>& modulus) : modulus_(modulus) {
+        size_ = kParts;
+        while (size_ > 0 && modulus_.parts[size_ - 1] == 0) {
+            size_--;
+        }
+
+        // Ньютон для -n^-1 mod 2^32: каждая итерация удваивает число верных битов
+        uint32_t inverse = modulus_.parts[0];
+        for (int i = 0; i < 4; i++) {
+            inverse *= 2 - modulus_.parts[0] * inverse;
+        }
+        inv_ = 0 - inverse;
+
+        // R mod n и R^2 mod n удвоениями, делений не требуется
+        uint_t<Bits> value = from_uint<Bits>(1);
+        for (size_t i = 0; i < 32 * size_; i++) {
+            double_mod(value);
+        }
+        one_ = value;
+        for (size_t i = 0; i < 32 * size_; i++) {
+            double_mod(value);
+        }
+        r2_ = value;
+    }
+
+    constexpr const uint_t<Bits>& modulus() const { return modulus_; }
+
+    // Единица в форме Монтгомери (R mod n)
+    constexpr const uint_t<Bits>& one() const { return one_; }
+
+    // value < modulus
+    constexpr uint_t<Bits> to_montgomery(const uint_t<Bits>& value) const {
+        return multiply(value, r2_);
+    }
+
+    constexpr uint_t<Bits> from_montgomery(const uint_t<Bits>& value) const {
+        return multiply(value, from_uint<Bits>(1));
+    }
+
+    // lhs * rhs * R^-1 mod n (CIOS). Время работы не зависит от значений аргументов
+    constexpr uint_t<Bits> multiply(const uint_t<Bits>& lhs, const uint_t<Bits>& rhs) const {
+        const size_t s = size_;
+        uint32_t t[kParts + 2] = {};
+        for (size_t i = 0; i < s; i++) {
+            uint64_t factor = lhs.parts[i];
+            uint64_t carry = 0;
+            for (size_t j = 0; j < s; j++) {
+                uint64_t cur = t[j] + factor * rhs.parts[j] + carry;
+                t[j] = static_cast<uint32_t>(cur);
+                carry = cur >> 32;
+            }
+            uint64_t cur = t[s] + carry;
+            t[s] = static_cast<uint32_t>(cur);
+            t[s + 1] = static_cast<uint32_t>(cur >> 32);
+
+            // Прибавляем m * n, чтобы младшее слово обнулилось, и сдвигаем на слово
+            uint64_t m = static_cast<uint32_t>(t[0] * inv_);
+            carry = (t[0] + m * modulus_.parts[0]) >> 32;
+            for (size_t j = 1; j < s; j++) {
+                cur = t[j] + m * modulus_.parts[j] + carry;
+                t[j - 1] = static_cast<uint32_t>(cur);
+                carry = cur >> 32;
+            }
+            cur = t[s] + carry;
+            t[s - 1] = static_cast<uint32_t>(cur);
+            t[s] = t[s + 1] + static_cast<uint32_t>(cur >> 32);
+        }
+
+        // t < 2n: вычитаем n всегда и выбираем результат маской, без ветвлений
+        uint_t<Bits> result;
+        uint64_t borrow = 0;
+        for (size_t j = 0; j < s; j++) {
+            uint64_t diff = (uint64_t)t[j] - modulus_.parts[j] - borrow;
+            result.parts[j] = static_cast<uint32_t>(diff);
+            borrow = diff >> 63;
+        }
+        uint32_t keep = 0 - static_cast<uint32_t>(borrow > t[s]);
+        for (size_t j = 0; j < s; j++) {
+            result.parts[j] = (t[j] & keep) | (result.parts[j] & ~keep);
+        }
+        return result;
+    }
+
+    // lhs * rhs mod n для обычных (не Монтгомери) lhs, rhs < n
+    constexpr uint_t<Bits> mulmod(const uint_t<Bits>& lhs, const uint_t<Bits>& rhs) const {
+        return multiply(multiply(lhs, rhs), r2_);
+    }
+
+    // base^exponent mod n скользящим окном; время зависит от битов показателя
+    constexpr uint_t<Bits> powmod(const uint_t<Bits>& base, const uint_t<Bits>& exponent) const {
+        uint_t<Bits> table[size_t(1) << (kWindow - 1)];
+        uint_t<Bits> x = to_montgomery(reduce(base));
+        uint_t<Bits> x2 = multiply(x, x);
+        table[0] = x;
+        for (size_t i = 1; i < std::size(table); i++) {
+            table[i] = multiply(table[i - 1], x2);
+        }
+
+        uint_t<Bits> result = one_;
+        int bit = top_bit(exponent);
+        while (bit >= 0) {
+            if (!test_bit(exponent, bit)) {
+                result = multiply(result, result);
+                bit--;
+                continue;
+            }
+            // Самое длинное окно не длиннее kWindow, заканчивающееся единичным битом
+            int low = std::max(bit - kWindow + 1, 0);
+            while (!test_bit(exponent, low)) {
+                low++;
+            }
+            uint32_t window = 0;
+            for (int i = bit; i >= low; i--) {
+                window = (window << 1) | test_bit(exponent, i);
+                result = multiply(result, result);
+            }
+            result = multiply(result, table[window >> 1]);
+            bit = low - 1;
+        }
+        return from_montgomery(result);
+    }
+
+    // Вариант powmod с постоянным временем: фиксированные окна по 4 бита по всей ширине
+    // показателя, элемент таблицы выбирается полным проходом с масками
+    constexpr uint_t<Bits> powmod_consttime(const uint_t<Bits>& base, const uint_t<Bits>& exponent) const {
+        uint_t<Bits> table[16];
+        table[0] = one_;
+        table[1] = to_montgomery(reduce(base));
+        for (size_t i = 2; i < 16; i++) {
+            table[i] = multiply(table[i - 1], table[1]);
+        }
+
+        uint_t<Bits> result = one_;
+        for (size_t i = kParts * 8; i-- > 0;) {
+            for (int k = 0; k < 4; k++) {
+                result = multiply(result, result);
+            }
+            uint32_t window = (exponent.parts[i / 8] >> (4 * (i % 8))) & 0xF;
+            uint_t<Bits> selected;
+            for (uint32_t w = 0; w < 16; w++) {
+                uint32_t mask = 0 - static_cast<uint32_t>(w == window);
+                for (size_t j = 0; j < size_; j++) {
+                    selected.parts[j] |= table[w].parts[j] & mask;
+                }
+            }
+            result = multiply(result, selected);
+        }
+        return from_montgomery(result);
+    }
+
+private:
+    constexpr uint_t<Bits> reduce(const uint_t<Bits>& value) const {
+        for (size_t i = kParts; i-- > 0;) {
+            if (value.parts[i] != modulus_.parts[i]) {
+                return value.parts[i] < modulus_.parts[i] ? value : value % modulus_;
+            }
+        }
+        return uint_t<Bits>();
+    }
+
+    // value = 2 * value mod n, value < n
+    constexpr void double_mod(uint_t<Bits>& value) const {
+        uint32_t carry = 0;
+        for (size_t i = 0; i < size_; i++) {
+            uint32_t next = value.parts[i] >> 31;
+            value.parts[i] = (value.parts[i] << 1) | carry;
+            carry = next;
+        }
+        bool at_least = carry != 0;
+        if (!at_least) {
+            at_least = true;
+            for (size_t i = size_; i-- > 0;) {
+                if (value.parts[i] != modulus_.parts[i]) {
+                    at_least = value.parts[i] > modulus_.parts[i];
+                    break;
+                }
+            }
+        }
+        if (at_least) {
+            uint64_t borrow = 0;
+            for (size_t i = 0; i < size_; i++) {
+                uint64_t diff = (uint64_t)value.parts[i] - modulus_.parts[i] - borrow;
+                value.parts[i] = static_cast<uint32_t>(diff);
+                borrow = diff >> 63;
+            }
+        }
+    }
+
+    static constexpr int top_bit(const uint_t<Bits>& value) {
+        for (size_t i = kParts; i-- > 0;) {
+            if (value.parts[i] != 0) {
+                return static_cast<int>(32 * i) + 31 - std::countl_zero(value.parts[i]);
+            }
+        }
+        return -1;
+    }
+
+    static constexpr uint32_t test_bit(const uint_t<Bits>& value, int bit) {
+        return (value.parts[bit / 32] >> (bit % 32)) & 1;
+    }
+
+    uint_t<Bits> modulus_;
+    uint_t<Bits> one_;
+    uint_t<Bits> r2_;
+    uint32_t inv_ = 0;
+    size_t size_ = 0;
+};
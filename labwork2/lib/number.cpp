@@ -1,115 +1,60 @@
 #include "number.h"
 #include <cstring>
-#include <algorithm>
 
-uint2022_t from_uint(uint32_t value) {
-    uint2022_t result;
-    memset(&result, 0, sizeof(result));
-    result.parts[0] = value;
-    return result;
-}
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
 
-uint2022_t from_string(const char* str) {
-    uint2022_t result = from_uint(0);
-    while (*str) {
-        if (isdigit(*str)) {
-            result = result * from_uint(10) + from_uint(*str - '0');
-        }
-        str++;
-    }
-    return result;
-}
+namespace {
 
-uint2022_t operator+(const uint2022_t& lhs, const uint2022_t& rhs) {
-    uint2022_t result;
-    uint64_t carry = 0;
-    for (int i = 0; i < 64; i++) {
-        uint64_t sum = (uint64_t)lhs.parts[i] + rhs.parts[i] + carry;
-        result.parts[i] = sum & 0xFFFFFFFF;
-        carry = sum >> 32;
-    }
-    return result;
+// SWAR: проверка и разбор восьми ASCII-цифр, лежащих в одном слове (little-endian)
+bool is_eight_digits(uint64_t chunk) {
+    return (((chunk + 0x4646464646464646) | (chunk - 0x3030303030303030)) & 0x8080808080808080) == 0;
 }
 
-uint2022_t operator-(const uint2022_t& lhs, const uint2022_t& rhs) {
-    uint2022_t result;
-    uint32_t borrow = 0;
-    for (int i = 0; i < 64; i++) {
-        uint64_t diff = (uint64_t)lhs.parts[i] - rhs.parts[i] - borrow;
-        borrow = (diff >> 32) ? 1 : 0;
-        result.parts[i] = diff & 0xFFFFFFFF;
-    }
-    return result;
+uint32_t parse_eight_digits(uint64_t chunk) {
+    chunk = ((chunk & 0x0F0F0F0F0F0F0F0F) * 2561) >> 8;
+    chunk = ((chunk & 0x00FF00FF00FF00FF) * 6553601) >> 16;
+    return static_cast<uint32_t>(((chunk & 0x0000FFFF0000FFFF) * 42949672960001) >> 32);
 }
 
-uint2022_t operator*(const uint2022_t& lhs, const uint2022_t& rhs) {
-    uint64_t temp[128] = { 0 };
-    for (int i = 0; i < 64; i++) {
-        for (int j = 0; j < 64; j++) {
-            uint64_t product = (uint64_t)lhs.parts[i] * rhs.parts[j];
-            temp[i + j] += product & 0xFFFFFFFF;
-            temp[i + j + 1] += product >> 32;
-        }
-    }
-    for (int k = 0; k < 127; k++) {
-        temp[k + 1] += temp[k] >> 32;
-        temp[k] &= 0xFFFFFFFF;
-    }
-    uint2022_t result;
-    for (int k = 0; k < 64; k++) {
-        result.parts[k] = temp[k] & 0xFFFFFFFF;
-    }
-    return result;
-}
-
-bool operator==(const uint2022_t& lhs, const uint2022_t& rhs) {
-    for (int i = 0; i < 64; i++) {
-        if (lhs.parts[i] != rhs.parts[i]) return false;
+#if defined(__SSSE3__)
+// Проверка и разбор шестнадцати цифр: high - первые восемь, low - вторые восемь
+bool parse_sixteen_digits(const char* str, uint32_t& high, uint32_t& low) {
+    __m128i digits = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(str)), _mm_set1_epi8('0'));
+    __m128i nine = _mm_set1_epi8(9);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(digits, nine), nine)) != 0xFFFF) {
+        return false;
     }
+    __m128i pairs = _mm_maddubs_epi16(digits, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+    __m128i quads = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    __m128i packed = _mm_packs_epi32(quads, quads);
+    __m128i octets = _mm_madd_epi16(packed, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+    high = static_cast<uint32_t>(_mm_cvtsi128_si32(octets));
+    low = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(octets, 4)));
     return true;
 }
+#endif
 
-bool operator!=(const uint2022_t& lhs, const uint2022_t& rhs) {
-    return !(lhs == rhs);
-}
+} // namespace
 
-// Вспомогательная функция: деление на 10 с остатком
-static std::pair<uint2022_t, uint32_t> divmod10(const uint2022_t& num) {
-    uint2022_t quotient;
-    memset(&quotient, 0, sizeof(quotient));
+namespace number_detail {
 
-    uint64_t remainder = 0;
-
-    for (int i = 63; i >= 0; i--) {
-        uint64_t current = (remainder << 32) | num.parts[i];
-        uint64_t digit = current / 10;
-        remainder = current % 10;
-
-        quotient.parts[i] = static_cast<uint32_t>(digit);
-    }
-
-    return { quotient, static_cast<uint32_t>(remainder) };
-}
-
-std::ostream& operator<<(std::ostream& stream, const uint2022_t& value) {
-    if (value == from_uint(0)) {
-        stream << "0";
-        return stream;
+int parse_digit_block(const char* str, size_t len, uint32_t& high, [[maybe_unused]] uint32_t& low) {
+#if defined(__SSSE3__)
+    if (len >= 16 && parse_sixteen_digits(str, high, low)) {
+        return 16;
     }
-
-    char buffer[610]; // 2022 бит ~ 610 цифр в десятичной
-    int index = 0;
-
-    uint2022_t num = value;
-    while (num != from_uint(0)) {
-        auto [quotient, remainder] = divmod10(num);
-        buffer[index++] = '0' + remainder;
-        num = quotient;
+#endif
+    if (len >= 8) {
+        uint64_t word;
+        memcpy(&word, str, 8);
+        if (is_eight_digits(word)) {
+            high = parse_eight_digits(word);
+            return 8;
+        }
     }
-
-    std::reverse(buffer, buffer + index);
-    buffer[index] = '\0';
-
-    stream << buffer;
-    return stream;
+    return 0;
 }
+
+} // namespace number_detail
@@ -1,27 +1,669 @@
 #pragma once
+#include "divisor.h"
+#include <algorithm>
+#include <bit>
 #include <cinttypes>
+#include <compare>
+#include <cstddef>
 #include <iostream>
+#include <string>
+#include <type_traits>
 
-struct uint2022_t {
-    uint32_t parts[64] = {};
+// Беззнаковое целое фиксированной длины из 32-битных слов (младшее слово - первое).
+// Арифметика ведется по модулю 2^(32 * kParts), переполнение - UB.
+template <size_t Bits>
+struct uint_t;
+
+template <typename Expr>
+struct is_uint_expr : std::false_type {};
+
+template <size_t Bits, typename Expr>
+constexpr uint_t<Bits>& assign(uint_t<Bits>& dst, const Expr& expr);
+
+template <size_t Bits>
+struct uint_t {
+    static constexpr size_t kBits = Bits;
+    static constexpr size_t kParts = (Bits + 31) / 32;
+
+    uint32_t parts[kParts] = {};
+
+    // Вычисление выражения вида a*b + c*d - e сразу в это число
+    template <typename Expr, typename = std::enable_if_t<is_uint_expr<Expr>::value>>
+    constexpr uint_t& operator=(const Expr& expr) {
+        return assign(*this, expr);
+    }
 };
 
+using uint256_t = uint_t<256>;
+using uint512_t = uint_t<512>;
+using uint2022_t = uint_t<2022>;
+using uint4096_t = uint_t<4096>;
+
 static_assert(sizeof(uint2022_t) <= 300, "Size of uint2022_t must be no higher than 300 bytes");
 
-uint2022_t from_uint(uint32_t i);
+namespace number_detail {
+
+// Разбор блока ASCII-цифр в начале строки длины len (SIMD/SWAR, см. number.cpp).
+// Возвращает 16 (high - первые восемь цифр, low - вторые), 8 (значение в high) или 0.
+int parse_digit_block(const char* str, size_t len, uint32_t& high, uint32_t& low);
+
+inline constexpr uint32_t kPow10[10] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+// Количество значащих слов числа; узкие числа всегда обходятся целиком,
+// чтобы границы циклов были константами и компилятор их развернул
+template <size_t Bits>
+constexpr size_t active_parts(const uint_t<Bits>& value) {
+    constexpr size_t kParts = uint_t<Bits>::kParts;
+    if constexpr (kParts <= 8) {
+        return kParts;
+    }
+    else {
+        size_t size = kParts;
+        while (size > 0 && value.parts[size - 1] == 0) {
+            size--;
+        }
+        return size;
+    }
+}
+
+// x = x * mul + add на месте; used - количество занятых слов, старшие нули не трогаем
+template <size_t Bits>
+constexpr void mul_add_word(uint_t<Bits>& x, size_t& used, uint32_t mul, uint32_t add) {
+    uint64_t carry = add;
+    for (size_t i = 0; i < used; i++) {
+        uint64_t cur = (uint64_t)x.parts[i] * mul + carry;
+        x.parts[i] = static_cast<uint32_t>(cur);
+        carry = cur >> 32;
+    }
+    if (carry != 0 && used < uint_t<Bits>::kParts) {
+        x.parts[used++] = static_cast<uint32_t>(carry);
+    }
+}
+
+// dst += factor * rhs * 2^(32 * offset); старшие слова за пределами kParts отбрасываются
+template <size_t Bits>
+constexpr void mul_add_row(uint_t<Bits>& dst, size_t offset, uint64_t factor, const uint_t<Bits>& rhs, size_t rhs_size) {
+    constexpr size_t kParts = uint_t<Bits>::kParts;
+    if (factor == 0) return;
+    size_t limit = std::min(rhs_size, kParts - offset);
+    uint64_t carry = 0;
+    size_t k = offset;
+    for (size_t j = 0; j < limit; j++, k++) {
+        uint64_t sum = dst.parts[k] + factor * rhs.parts[j] + carry;
+        dst.parts[k] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+    for (; carry != 0 && k < kParts; k++) {
+        uint64_t sum = dst.parts[k] + carry;
+        dst.parts[k] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+}
+
+// dst -= factor * rhs * 2^(32 * offset)
+template <size_t Bits>
+constexpr void mul_sub_row(uint_t<Bits>& dst, size_t offset, uint64_t factor, const uint_t<Bits>& rhs, size_t rhs_size) {
+    constexpr size_t kParts = uint_t<Bits>::kParts;
+    if (factor == 0) return;
+    size_t limit = std::min(rhs_size, kParts - offset);
+    uint64_t borrow = 0;
+    size_t k = offset;
+    for (size_t j = 0; j < limit; j++, k++) {
+        uint64_t product = factor * rhs.parts[j] + borrow;
+        uint32_t low = static_cast<uint32_t>(product);
+        borrow = (product >> 32) + (dst.parts[k] < low);
+        dst.parts[k] -= low;
+    }
+    for (; borrow != 0 && k < kParts; k++) {
+        uint32_t low = static_cast<uint32_t>(borrow);
+        borrow = (borrow >> 32) + (dst.parts[k] < low);
+        dst.parts[k] -= low;
+    }
+}
+
+} // namespace number_detail
+
+// Деление на делитель с заранее посчитанной обратной величиной, возвращает остаток.
+// quotient может совпадать с num
+template <size_t Bits>
+constexpr uint64_t divmod(const uint_t<Bits>& num, const invariant_divisor& divisor, uint_t<Bits>& quotient) {
+    constexpr size_t kParts = uint_t<Bits>::kParts;
+    const int shift = divisor.shift();
+    size_t size = kParts;
+    while (size > 0 && num.parts[size - 1] == 0) {
+        size--;
+    }
+    for (size_t i = size; i < kParts; i++) {
+        quotient.parts[i] = 0;
+    }
+
+    // Делимое сдвигается на shift бит на лету, по слову за шаг
+    uint64_t remainder = 0;
+    for (size_t i = size + 1; i-- > 0;) {
+        uint32_t upper = i < size ? num.parts[i] : 0;
+        uint32_t lower = i > 0 ? num.parts[i - 1] : 0;
+        uint32_t word = (upper << shift) | static_cast<uint32_t>((uint64_t)lower >> (32 - shift));
+        uint32_t digit = divisor.step(remainder, word);
+        if (i < size) {
+            quotient.parts[i] = digit;
+        }
+    }
+    return remainder >> shift;
+}
+
+namespace number_detail {
+
+// Деление столбиком по Кнуту (алгоритм D), слова по 32 бита
+template <size_t Bits>
+constexpr void divmod(const uint_t<Bits>& num, const uint_t<Bits>& den, uint_t<Bits>& quotient, uint_t<Bits>& remainder) {
+    constexpr size_t kParts = uint_t<Bits>::kParts;
+    size_t n = kParts;
+    size_t m = kParts;
+    while (n > 0 && den.parts[n - 1] == 0) n--;
+    while (m > 0 && num.parts[m - 1] == 0) m--;
+    quotient = uint_t<Bits>();
+    remainder = uint_t<Bits>();
+    if (n == 0) {
+        return; // деление на ноль - UB
+    }
+    if (m < n) {
+        remainder = num;
+        return;
+    }
+    if (n <= 2) {
+        uint64_t value = den.parts[0];
+        if constexpr (kParts > 1) {
+            value |= (uint64_t)den.parts[1] << 32;
+        }
+        uint64_t rest = ::divmod(num, invariant_divisor(value), quotient);
+        remainder.parts[0] = static_cast<uint32_t>(rest);
+        if constexpr (kParts > 1) {
+            remainder.parts[1] = static_cast<uint32_t>(rest >> 32);
+        }
+        return;
+    }
+
+    // Нормализация: старший бит делителя должен быть единицей
+    int shift = std::countl_zero(den.parts[n - 1]);
+    uint32_t vn[kParts] = {};
+    uint32_t un[kParts + 1] = {};
+    for (size_t i = n - 1; i > 0; i--) {
+        vn[i] = (den.parts[i] << shift) | (shift ? static_cast<uint32_t>((uint64_t)den.parts[i - 1] >> (32 - shift)) : 0);
+    }
+    vn[0] = den.parts[0] << shift;
+    un[m] = shift ? static_cast<uint32_t>((uint64_t)num.parts[m - 1] >> (32 - shift)) : 0;
+    for (size_t i = m - 1; i > 0; i--) {
+        un[i] = (num.parts[i] << shift) | (shift ? static_cast<uint32_t>((uint64_t)num.parts[i - 1] >> (32 - shift)) : 0);
+    }
+    un[0] = num.parts[0] << shift;
+
+    for (size_t j = m - n + 1; j-- > 0;) {
+        uint64_t top = ((uint64_t)un[j + n] << 32) | un[j + n - 1];
+        uint64_t qhat = top / vn[n - 1];
+        uint64_t rhat = top % vn[n - 1];
+        while (qhat >> 32 || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+            qhat--;
+            rhat += vn[n - 1];
+            if (rhat >> 32) break;
+        }
+
+        int64_t borrow = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t product = qhat * vn[i];
+            int64_t diff = (int64_t)un[i + j] - borrow - (int64_t)(product & 0xFFFFFFFF);
+            un[i + j] = static_cast<uint32_t>(diff);
+            borrow = (int64_t)(product >> 32) - (diff >> 32);
+        }
+        int64_t diff = (int64_t)un[j + n] - borrow;
+        un[j + n] = static_cast<uint32_t>(diff);
+
+        if (diff < 0) {
+            // Оценка оказалась на единицу больше - возвращаем делитель
+            qhat--;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; i++) {
+                uint64_t sum = (uint64_t)un[i + j] + vn[i] + carry;
+                un[i + j] = static_cast<uint32_t>(sum);
+                carry = sum >> 32;
+            }
+            un[j + n] += static_cast<uint32_t>(carry);
+        }
+        quotient.parts[j] = static_cast<uint32_t>(qhat);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        remainder.parts[i] = (un[i] >> shift) | (shift ? static_cast<uint32_t>((uint64_t)un[i + 1] << (32 - shift)) : 0);
+    }
+}
+
+} // namespace number_detail
+
+template <size_t Bits = 2022>
+constexpr uint_t<Bits> from_uint(uint32_t value) {
+    uint_t<Bits> result;
+    result.parts[0] = value;
+    return result;
+}
+
+template <size_t Bits = 2022>
+constexpr uint_t<Bits> from_string(const char* str) {
+    using number_detail::kPow10;
+    uint_t<Bits> result;
+    size_t used = 1;
+    uint32_t chunk = 0;
+    int chunk_len = 0;
+    const char* end = str + std::char_traits<char>::length(str);
+
+    // Цифры копятся в одно слово по 8-9 штук, затем одно умножение-сложение на всё число
+    while (str < end) {
+        if (chunk_len == 0 && !std::is_constant_evaluated()) {
+            uint32_t high = 0;
+            uint32_t low = 0;
+            int digits = number_detail::parse_digit_block(str, end - str, high, low);
+            if (digits > 0) {
+                number_detail::mul_add_word(result, used, kPow10[8], high);
+                if (digits == 16) {
+                    number_detail::mul_add_word(result, used, kPow10[8], low);
+                }
+                str += digits;
+                continue;
+            }
+        }
+        if (*str >= '0' && *str <= '9') {
+            chunk = chunk * 10 + (*str - '0');
+            if (++chunk_len == 9) {
+                number_detail::mul_add_word(result, used, kPow10[9], chunk);
+                chunk = 0;
+                chunk_len = 0;
+            }
+        }
+        str++;
+    }
+    if (chunk_len > 0) {
+        number_detail::mul_add_word(result, used, kPow10[chunk_len], chunk);
+    }
+    return result;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits>& operator+=(uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < uint_t<Bits>::kParts; i++) {
+        uint64_t sum = (uint64_t)lhs.parts[i] + rhs.parts[i] + carry;
+        lhs.parts[i] = sum & 0xFFFFFFFF;
+        carry = sum >> 32;
+    }
+    return lhs;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits>& operator-=(uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    uint32_t borrow = 0;
+    for (size_t i = 0; i < uint_t<Bits>::kParts; i++) {
+        uint64_t diff = (uint64_t)lhs.parts[i] - rhs.parts[i] - borrow;
+        borrow = (diff >> 32) ? 1 : 0;
+        lhs.parts[i] = diff & 0xFFFFFFFF;
+    }
+    return lhs;
+}
+
+// dst += lhs * rhs (или dst -= lhs * rhs) без промежуточного произведения
+template <size_t Bits>
+constexpr void mul_accumulate(uint_t<Bits>& dst, const uint_t<Bits>& lhs, const uint_t<Bits>& rhs, bool subtract) {
+    size_t lhs_size = number_detail::active_parts(lhs);
+    size_t rhs_size = number_detail::active_parts(rhs);
+    for (size_t i = 0; i < lhs_size; i++) {
+        if (subtract) {
+            number_detail::mul_sub_row(dst, i, lhs.parts[i], rhs, rhs_size);
+        }
+        else {
+            number_detail::mul_add_row(dst, i, lhs.parts[i], rhs, rhs_size);
+        }
+    }
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits>& operator*=(uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    if (&lhs == &rhs) {
+        uint_t<Bits> factor = rhs;
+        return lhs *= factor;
+    }
+    // Идем от старших слов: строка i пишет только в слова >= i, которые уже использованы
+    size_t rhs_size = number_detail::active_parts(rhs);
+    for (size_t i = number_detail::active_parts(lhs); i-- > 0;) {
+        uint64_t factor = lhs.parts[i];
+        lhs.parts[i] = 0;
+        number_detail::mul_add_row(lhs, i, factor, rhs, rhs_size);
+    }
+    return lhs;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator+(const uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    uint_t<Bits> result = lhs;
+    return result += rhs;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator-(const uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    uint_t<Bits> result = lhs;
+    return result -= rhs;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator*(const uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    uint_t<Bits> result;
+    mul_accumulate(result, lhs, rhs, false);
+    return result;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator/(const uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    uint_t<Bits> quotient;
+    uint_t<Bits> remainder;
+    number_detail::divmod(lhs, rhs, quotient, remainder);
+    return quotient;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator%(const uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    uint_t<Bits> quotient;
+    uint_t<Bits> remainder;
+    number_detail::divmod(lhs, rhs, quotient, remainder);
+    return remainder;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits>& operator/=(uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    return lhs = lhs / rhs;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits>& operator%=(uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    return lhs = lhs % rhs;
+}
+
+template <size_t Bits>
+constexpr bool operator==(const uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    for (size_t i = 0; i < uint_t<Bits>::kParts; i++) {
+        if (lhs.parts[i] != rhs.parts[i]) return false;
+    }
+    return true;
+}
+
+template <size_t Bits>
+constexpr bool operator!=(const uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    return !(lhs == rhs);
+}
+
+// Сравнение идет от старших слов, до первого различия
+template <size_t Bits>
+constexpr std::strong_ordering operator<=>(const uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    for (size_t i = uint_t<Bits>::kParts; i-- > 0;) {
+        if (lhs.parts[i] != rhs.parts[i]) {
+            return lhs.parts[i] <=> rhs.parts[i];
+        }
+    }
+    return std::strong_ordering::equal;
+}
+
+// Сдвиги: перенос целых слов плюс сдвиг пары соседних слов (funnel shift)
+template <size_t Bits>
+constexpr uint_t<Bits>& operator<<=(uint_t<Bits>& value, size_t shift) {
+    constexpr size_t kParts = uint_t<Bits>::kParts;
+    const size_t words = shift / 32;
+    const unsigned bits = shift % 32;
+    if (words >= kParts) {
+        return value = uint_t<Bits>();
+    }
+    for (size_t i = kParts; i-- > words + 1;) {
+        uint64_t pair = ((uint64_t)value.parts[i - words] << 32) | value.parts[i - words - 1];
+        value.parts[i] = static_cast<uint32_t>(pair >> (32 - bits));
+    }
+    value.parts[words] = value.parts[0] << bits;
+    for (size_t i = 0; i < words; i++) {
+        value.parts[i] = 0;
+    }
+    return value;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits>& operator>>=(uint_t<Bits>& value, size_t shift) {
+    constexpr size_t kParts = uint_t<Bits>::kParts;
+    const size_t words = shift / 32;
+    const unsigned bits = shift % 32;
+    if (words >= kParts) {
+        return value = uint_t<Bits>();
+    }
+    for (size_t i = 0; i + words + 1 < kParts; i++) {
+        uint64_t pair = ((uint64_t)value.parts[i + words + 1] << 32) | value.parts[i + words];
+        value.parts[i] = static_cast<uint32_t>(pair >> bits);
+    }
+    value.parts[kParts - words - 1] = value.parts[kParts - 1] >> bits;
+    for (size_t i = kParts - words; i < kParts; i++) {
+        value.parts[i] = 0;
+    }
+    return value;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator<<(const uint_t<Bits>& value, size_t shift) {
+    uint_t<Bits> result = value;
+    return result <<= shift;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator>>(const uint_t<Bits>& value, size_t shift) {
+    uint_t<Bits> result = value;
+    return result >>= shift;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits>& operator&=(uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    for (size_t i = 0; i < uint_t<Bits>::kParts; i++) {
+        lhs.parts[i] &= rhs.parts[i];
+    }
+    return lhs;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits>& operator|=(uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    for (size_t i = 0; i < uint_t<Bits>::kParts; i++) {
+        lhs.parts[i] |= rhs.parts[i];
+    }
+    return lhs;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits>& operator^=(uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    for (size_t i = 0; i < uint_t<Bits>::kParts; i++) {
+        lhs.parts[i] ^= rhs.parts[i];
+    }
+    return lhs;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator&(const uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    uint_t<Bits> result = lhs;
+    return result &= rhs;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator|(const uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    uint_t<Bits> result = lhs;
+    return result |= rhs;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator^(const uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    uint_t<Bits> result = lhs;
+    return result ^= rhs;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator~(const uint_t<Bits>& value) {
+    uint_t<Bits> result;
+    for (size_t i = 0; i < uint_t<Bits>::kParts; i++) {
+        result.parts[i] = ~value.parts[i];
+    }
+    return result;
+}
+
+template <size_t Bits>
+std::ostream& operator<<(std::ostream& stream, const uint_t<Bits>& value) {
+    if (value == uint_t<Bits>()) {
+        stream << "0";
+        return stream;
+    }
+
+    // Число режется на куски по девять цифр делением на 10^9 без аппаратного деления
+    constexpr invariant_divisor kBillion(1000000000);
+    constexpr size_t kSize = uint_t<Bits>::kParts * 10 + 9; // в одном слове не больше 10 десятичных цифр
+    char buffer[kSize + 1];
+    size_t index = kSize;
+    buffer[index] = '\0';
+
+    uint_t<Bits> num = value;
+    while (num != uint_t<Bits>()) {
+        uint32_t chunk = static_cast<uint32_t>(divmod(num, kBillion, num));
+        for (int i = 0; i < 9; i++) {
+            buffer[--index] = static_cast<char>('0' + chunk % 10);
+            chunk /= 10;
+        }
+    }
+    while (buffer[index] == '0') {
+        index++;
+    }
+
+    stream << buffer + index;
+    return stream;
+}
+
+// Отложенное произведение, создается через mul(a, b)
+template <size_t Bits>
+struct uint_product {
+    const uint_t<Bits>& lhs;
+    const uint_t<Bits>& rhs;
+};
+
+template <size_t Bits>
+constexpr uint_product<Bits> mul(const uint_t<Bits>& lhs, const uint_t<Bits>& rhs) {
+    return { lhs, rhs };
+}
+
+// Отложенная сумма (Subtract == false) или разность двух подвыражений
+template <typename Lhs, typename Rhs, bool Subtract>
+struct uint_sum {
+    Lhs lhs;
+    Rhs rhs;
+};
+
+template <size_t Bits>
+struct is_uint_expr<uint_product<Bits>> : std::true_type {};
+
+template <typename Lhs, typename Rhs, bool Subtract>
+struct is_uint_expr<uint_sum<Lhs, Rhs, Subtract>> : std::true_type {};
+
+template <typename T>
+struct is_uint : std::false_type {};
+
+template <size_t Bits>
+struct is_uint<uint_t<Bits>> : std::true_type {};
+
+// Сами числа хранятся в выражении по ссылке, подвыражения - по значению
+template <typename T>
+using uint_operand_t = std::conditional_t<is_uint<T>::value, const T&, T>;
+
+template <typename Lhs, typename Rhs>
+constexpr bool uint_expr_operands_v =
+    (is_uint_expr<Lhs>::value || is_uint_expr<Rhs>::value) &&
+    (is_uint_expr<Lhs>::value || is_uint<Lhs>::value) &&
+    (is_uint_expr<Rhs>::value || is_uint<Rhs>::value);
+
+template <typename Lhs, typename Rhs, typename = std::enable_if_t<uint_expr_operands_v<Lhs, Rhs>>>
+constexpr uint_sum<uint_operand_t<Lhs>, uint_operand_t<Rhs>, false> operator+(const Lhs& lhs, const Rhs& rhs) {
+    return { lhs, rhs };
+}
+
+template <typename Lhs, typename Rhs, typename = std::enable_if_t<uint_expr_operands_v<Lhs, Rhs>>>
+constexpr uint_sum<uint_operand_t<Lhs>, uint_operand_t<Rhs>, true> operator-(const Lhs& lhs, const Rhs& rhs) {
+    return { lhs, rhs };
+}
+
+namespace number_detail {
+
+template <size_t Bits>
+constexpr bool aliases(const uint_t<Bits>& value, const uint_t<Bits>* dst) {
+    return &value == dst;
+}
+
+template <size_t Bits>
+constexpr bool aliases(const uint_product<Bits>& expr, const uint_t<Bits>* dst) {
+    return &expr.lhs == dst || &expr.rhs == dst;
+}
 
-uint2022_t from_string(const char* buff);
+template <size_t Bits, typename Lhs, typename Rhs, bool Subtract>
+constexpr bool aliases(const uint_sum<Lhs, Rhs, Subtract>& expr, const uint_t<Bits>* dst) {
+    return aliases(expr.lhs, dst) || aliases(expr.rhs, dst);
+}
 
-uint2022_t operator+(const uint2022_t& lhs, const uint2022_t& rhs);
+template <size_t Bits>
+constexpr void accumulate(uint_t<Bits>& dst, const uint_t<Bits>& value, bool subtract) {
+    if (subtract) {
+        dst -= value;
+    }
+    else {
+        dst += value;
+    }
+}
 
-uint2022_t operator-(const uint2022_t& lhs, const uint2022_t& rhs);
+template <size_t Bits>
+constexpr void accumulate(uint_t<Bits>& dst, const uint_product<Bits>& expr, bool subtract) {
+    mul_accumulate(dst, expr.lhs, expr.rhs, subtract);
+}
 
-uint2022_t operator*(const uint2022_t& lhs, const uint2022_t& rhs);
+template <size_t Bits, typename Lhs, typename Rhs, bool Subtract>
+constexpr void accumulate(uint_t<Bits>& dst, const uint_sum<Lhs, Rhs, Subtract>& expr, bool subtract) {
+    accumulate(dst, expr.lhs, subtract);
+    accumulate(dst, expr.rhs, subtract != Subtract);
+}
 
-uint2022_t operator/(const uint2022_t& lhs, const uint2022_t& rhs);
+} // namespace number_detail
 
-bool operator==(const uint2022_t& lhs, const uint2022_t& rhs);
+template <size_t Bits, typename Expr>
+constexpr uint_t<Bits>& assign(uint_t<Bits>& dst, const Expr& expr) {
+    if (number_detail::aliases(expr, &dst)) {
+        uint_t<Bits> result;
+        number_detail::accumulate(result, expr, false);
+        dst = result;
+    }
+    else {
+        dst = uint_t<Bits>();
+        number_detail::accumulate(dst, expr, false);
+    }
+    return dst;
+}
 
-bool operator!=(const uint2022_t& lhs, const uint2022_t& rhs);
+template <size_t Bits, typename Expr, typename = std::enable_if_t<is_uint_expr<Expr>::value>>
+constexpr uint_t<Bits>& operator+=(uint_t<Bits>& dst, const Expr& expr) {
+    if (number_detail::aliases(expr, &dst)) {
+        uint_t<Bits> addend;
+        number_detail::accumulate(addend, expr, false);
+        return dst += addend;
+    }
+    number_detail::accumulate(dst, expr, false);
+    return dst;
+}
 
-std::ostream& operator<<(std::ostream& stream, const uint2022_t& value);
+template <size_t Bits, typename Expr, typename = std::enable_if_t<is_uint_expr<Expr>::value>>
+constexpr uint_t<Bits>& operator-=(uint_t<Bits>& dst, const Expr& expr) {
+    if (number_detail::aliases(expr, &dst)) {
+        uint_t<Bits> subtrahend;
+        number_detail::accumulate(subtrahend, expr, false);
+        return dst -= subtrahend;
+    }
+    number_detail::accumulate(dst, expr, true);
+    return dst;
+}
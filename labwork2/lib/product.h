@@ -0,0 +1,280 @@
+#pragma once
+#include "number.h"
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+template <size_t Bits>
+struct product_result {
+    uint_t<Bits> value;
+    bool overflow = false; // точное произведение не поместилось в Bits бит, value - младшие слова
+};
+
+namespace number_detail {
+
+// Ниже этого размера (в словах) Карацуба проигрывает умножению столбиком
+inline constexpr size_t kKaratsubaThreshold = 24;
+// Размер листа дерева произведений
+inline constexpr size_t kProductLeaf = 16;
+
+// out[0, la + lb) = a * b
+inline void mul_schoolbook(const uint32_t* a, size_t la, const uint32_t* b, size_t lb, uint32_t* out) {
+    std::fill(out, out + la + lb, 0);
+    for (size_t i = 0; i < la; i++) {
+        uint64_t factor = a[i];
+        uint64_t carry = 0;
+        for (size_t j = 0; j < lb; j++) {
+            uint64_t cur = out[i + j] + factor * b[j] + carry;
+            out[i + j] = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+        out[i + lb] = static_cast<uint32_t>(carry);
+    }
+}
+
+// dst[0, len) += src[0, src_len), возвращает перенос из старшего слова
+inline uint32_t add_limbs(uint32_t* dst, size_t len, const uint32_t* src, size_t src_len) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < len && (i < src_len || carry != 0); i++) {
+        uint64_t sum = (uint64_t)dst[i] + (i < src_len ? src[i] : 0) + carry;
+        dst[i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+// dst[0, len) -= src[0, src_len), dst >= src
+inline void sub_limbs(uint32_t* dst, size_t len, const uint32_t* src, size_t src_len) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < len && (i < src_len || borrow != 0); i++) {
+        uint64_t diff = (uint64_t)dst[i] - (i < src_len ? src[i] : 0) - borrow;
+        dst[i] = static_cast<uint32_t>(diff);
+        borrow = diff >> 63;
+    }
+}
+
+// Сколько слов рабочей памяти нужно mul_karatsuba для множителей по n слов:
+// на каждом уровне 4 (h + 1) слова под суммы половин и их произведение, плюс память
+// рекурсивного вызова для этого произведения. Два других вызова идут раньше и
+// пользуются той же памятью
+constexpr size_t karatsuba_scratch(size_t n) {
+    if (n < kKaratsubaThreshold) {
+        return 0;
+    }
+    const size_t h = n - n / 2;
+    return 4 * (h + 1) + karatsuba_scratch(h + 1);
+}
+
+// out[0, 2n) = a * b, оба множителя по n слов; scratch - karatsuba_scratch(n) слов
+inline void mul_karatsuba(const uint32_t* a, const uint32_t* b, size_t n, uint32_t* out, uint32_t* scratch) {
+    if (n < kKaratsubaThreshold) {
+        mul_schoolbook(a, n, b, n, out);
+        return;
+    }
+    const size_t m = n / 2;
+    const size_t h = n - m;
+    mul_karatsuba(a, b, m, out, scratch);
+    mul_karatsuba(a + m, b + m, h, out + 2 * m, scratch);
+
+    // (a0 + a1)(b0 + b1) - a0*b0 - a1*b1 = a0*b1 + a1*b0
+    uint32_t* sa = scratch;
+    uint32_t* sb = sa + (h + 1);
+    uint32_t* middle = sb + (h + 1);
+    const size_t middle_size = 2 * (h + 1);
+    std::copy(a + m, a + n, sa);
+    std::copy(b + m, b + n, sb);
+    sa[h] = add_limbs(sa, h, a, m);
+    sb[h] = add_limbs(sb, h, b, m);
+    mul_karatsuba(sa, sb, h + 1, middle, middle + middle_size);
+    sub_limbs(middle, middle_size, out, 2 * m);
+    sub_limbs(middle, middle_size, out + 2 * m, 2 * h);
+    add_limbs(out + m, 2 * n - m, middle, std::min(middle_size, 2 * n - m));
+}
+
+} // namespace number_detail
+
+// out = lhs * rhs (младшие слова); возвращает true, если точное произведение не помещается в Bits бит.
+// Длинные множители умножаются по Карацубе
+template <size_t Bits>
+bool mul_checked(const uint_t<Bits>& lhs, const uint_t<Bits>& rhs, uint_t<Bits>& out) {
+    constexpr size_t kParts = uint_t<Bits>::kParts;
+    size_t la = kParts;
+    size_t lb = kParts;
+    while (la > 0 && lhs.parts[la - 1] == 0) la--;
+    while (lb > 0 && rhs.parts[lb - 1] == 0) lb--;
+    if (la == 0 || lb == 0) {
+        out = uint_t<Bits>();
+        return false;
+    }
+
+    // Старшие слова за la и lb нулевые, так что множители читаются прямо из parts.
+    // Весь расчет - на стеке, без выделений памяти
+    uint32_t full[2 * kParts];
+    size_t full_size;
+    if (std::min(la, lb) < number_detail::kKaratsubaThreshold) {
+        full_size = la + lb;
+        number_detail::mul_schoolbook(lhs.parts, la, rhs.parts, lb, full);
+    }
+    else {
+        const size_t n = std::max(la, lb);
+        uint32_t scratch[number_detail::karatsuba_scratch(kParts) + 1];
+        full_size = 2 * n;
+        number_detail::mul_karatsuba(lhs.parts, rhs.parts, n, full, scratch);
+    }
+
+    bool overflow = false;
+    for (size_t i = 0; i < full_size; i++) {
+        if (i < kParts) {
+            out.parts[i] = full[i];
+        }
+        else if (full[i] != 0) {
+            overflow = true;
+        }
+    }
+    for (size_t i = full_size; i < kParts; i++) {
+        out.parts[i] = 0;
+    }
+    if constexpr (Bits % 32 != 0) {
+        overflow = overflow || (out.parts[kParts - 1] >> (Bits % 32)) != 0;
+    }
+    return overflow;
+}
+
+namespace number_detail {
+
+template <size_t Bits>
+product_result<Bits> combine(const product_result<Bits>& lhs, const product_result<Bits>& rhs) {
+    product_result<Bits> result;
+    result.overflow = mul_checked(lhs.value, rhs.value, result.value) || lhs.overflow || rhs.overflow;
+    return result;
+}
+
+// Сбалансированное дерево над [first, last): leaf(first, last) считает произведение листа
+template <size_t Bits, typename Leaf>
+product_result<Bits> product_tree(size_t first, size_t last, const Leaf& leaf) {
+    if (last - first <= kProductLeaf) {
+        return leaf(first, last);
+    }
+    size_t middle = first + (last - first) / 2;
+    return combine(product_tree<Bits>(first, middle, leaf), product_tree<Bits>(middle, last, leaf));
+}
+
+// Последовательность делится на равные части по потокам, каждая сворачивается деревом,
+// затем результаты попарно перемножаются теми же потоками: часть i после своего листа
+// ждет соседей i + 1, i + 2, i + 4, ..., пока i делится на удвоенный шаг, и домножает
+// их результаты к себе. Последние, самые крупные умножения получаются между множителями
+// близкой длины - это размер, где работает Карацуба.
+// Исключение в любой части (например, bad_alloc) ловится, все потоки доходят до конца,
+// и оно пробрасывается после join; если поток не удалось создать, его части считает
+// вызывающий поток
+template <size_t Bits, typename Leaf>
+product_result<Bits> parallel_product(size_t count, const Leaf& leaf, unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t parts = std::min<size_t>(threads, (count + kProductLeaf - 1) / kProductLeaf);
+    if (parts <= 1) {
+        return product_tree<Bits>(0, count, leaf);
+    }
+
+    std::vector<product_result<Bits>> partial(parts);
+    std::vector<std::atomic<bool>> ready(parts);
+    std::atomic<bool> failed = false;
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto run = [&](size_t i) {
+        try {
+            partial[i] = product_tree<Bits>(count * i / parts, count * (i + 1) / parts, leaf);
+            for (size_t step = 1; i % (2 * step) == 0 && i + step < parts; step *= 2) {
+                ready[i + step].wait(false);
+                if (failed) {
+                    break;
+                }
+                partial[i] = combine(partial[i], partial[i + step]);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            failed = true;
+        }
+        ready[i] = true;
+        ready[i].notify_one();
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(parts - 1);
+        size_t started = 1;
+        try {
+            for (; started < parts; started++) {
+                workers.emplace_back(run, started);
+            }
+        } catch (...) {
+            // Части не запущенных потоков - в обратном порядке, чтобы соседи были готовы
+            for (size_t i = parts; i-- > started;) {
+                run(i);
+            }
+        }
+        run(0);
+    } // jthread присоединяется в деструкторе
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return partial[0];
+}
+
+} // namespace number_detail
+
+// Произведение values[0] * ... * values[count - 1]; threads == 0 - по числу ядер
+template <size_t Bits>
+product_result<Bits> product(const uint_t<Bits>* values, size_t count, unsigned threads = 0) {
+    if (count == 0) {
+        return { from_uint<Bits>(1), false };
+    }
+    auto leaf = [values](size_t first, size_t last) {
+        product_result<Bits> result = { values[first], false };
+        for (size_t i = first + 1; i < last; i++) {
+            result = number_detail::combine(result, product_result<Bits>{ values[i], false });
+        }
+        return result;
+    };
+    return number_detail::parallel_product<Bits>(count, leaf, threads);
+}
+
+// first * (first + 1) * ... * last
+template <size_t Bits = 2022>
+product_result<Bits> product_range(uint32_t first, uint32_t last, unsigned threads = 0) {
+    constexpr size_t kParts = uint_t<Bits>::kParts;
+    if (first > last) {
+        return { from_uint<Bits>(1), false };
+    }
+    // Внутри листа множители однословные: умножение на слово за один проход
+    auto leaf = [first](size_t lo, size_t hi) {
+        product_result<Bits> result = { from_uint<Bits>(1), false };
+        for (size_t i = lo; i < hi; i++) {
+            uint64_t factor = first + i;
+            uint64_t carry = 0;
+            for (size_t j = 0; j < kParts; j++) {
+                uint64_t cur = result.value.parts[j] * factor + carry;
+                result.value.parts[j] = static_cast<uint32_t>(cur);
+                carry = cur >> 32;
+            }
+            result.overflow = result.overflow || carry != 0;
+        }
+        if constexpr (Bits % 32 != 0) {
+            result.overflow = result.overflow || (result.value.parts[kParts - 1] >> (Bits % 32)) != 0;
+        }
+        return result;
+    };
+    return number_detail::parallel_product<Bits>(size_t(last) - first + 1, leaf, threads);
+}
+
+template <size_t Bits = 2022>
+product_result<Bits> factorial(uint32_t n, unsigned threads = 0) {
+    return n < 2 ? product_result<Bits>{ from_uint<Bits>(1), false } : product_range<Bits>(2, n, threads);
+}
@@ -0,0 +1,61 @@
+#include "serialize.h"
+#include <array>
+
+namespace {
+
+// Пары шестнадцатеричных цифр для каждого байта
+constexpr std::array<char, 512> make_hex_pairs() {
+    const char digits[] = "0123456789abcdef";
+    std::array<char, 512> table = {};
+    for (int i = 0; i < 256; i++) {
+        table[2 * i] = digits[i >> 4];
+        table[2 * i + 1] = digits[i & 0xF];
+    }
+    return table;
+}
+
+// Значение шестнадцатеричной цифры или 0xFF для остальных символов
+constexpr std::array<uint8_t, 256> make_hex_values() {
+    std::array<uint8_t, 256> table = {};
+    for (int i = 0; i < 256; i++) {
+        table[i] = 0xFF;
+    }
+    for (int i = 0; i < 10; i++) {
+        table['0' + i] = static_cast<uint8_t>(i);
+    }
+    for (int i = 0; i < 6; i++) {
+        table['a' + i] = static_cast<uint8_t>(10 + i);
+        table['A' + i] = static_cast<uint8_t>(10 + i);
+    }
+    return table;
+}
+
+constexpr std::array<char, 512> kHexPairs = make_hex_pairs();
+constexpr std::array<uint8_t, 256> kHexValues = make_hex_values();
+
+} // namespace
+
+namespace number_detail {
+
+void format_hex_word(uint32_t word, char* out) {
+    for (int i = 0; i < 4; i++) {
+        const char* pair = kHexPairs.data() + 2 * ((word >> (24 - 8 * i)) & 0xFF);
+        out[2 * i] = pair[0];
+        out[2 * i + 1] = pair[1];
+    }
+}
+
+bool parse_hex_word(const char* str, size_t len, uint32_t& word) {
+    // Ошибки копятся в старшем бите, проверка одна на слово
+    uint32_t result = 0;
+    uint8_t invalid = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t digit = kHexValues[static_cast<uint8_t>(str[i])];
+        invalid |= digit;
+        result = (result << 4) | (digit & 0xF);
+    }
+    word = result;
+    return (invalid & 0x80) == 0;
+}
+
+} // namespace number_detail
@@ -0,0 +1,161 @@
+#pragma once
+#include "number.h"
+#include <bit>
+#include <cstring>
+#include <string>
+
+namespace number_detail {
+
+// Восемь шестнадцатеричных цифр слова, старшая первой (см. serialize.cpp)
+void format_hex_word(uint32_t word, char* out);
+
+// Разбор до восьми шестнадцатеричных цифр; false, если встретился не hex-символ
+bool parse_hex_word(const char* str, size_t len, uint32_t& word);
+
+} // namespace number_detail
+
+// Фиксированный двоичный формат: все слова подряд, little-endian, binary_size<Bits> байт
+template <size_t Bits>
+inline constexpr size_t binary_size = uint_t<Bits>::kParts * sizeof(uint32_t);
+
+template <size_t Bits>
+void to_bytes(const uint_t<Bits>& value, uint8_t* out) {
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(out, value.parts, binary_size<Bits>);
+    }
+    else {
+        for (size_t i = 0; i < uint_t<Bits>::kParts; i++) {
+            for (size_t k = 0; k < 4; k++) {
+                out[4 * i + k] = static_cast<uint8_t>(value.parts[i] >> (8 * k));
+            }
+        }
+    }
+}
+
+template <size_t Bits>
+uint_t<Bits> from_bytes(const uint8_t* data) {
+    uint_t<Bits> value;
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(value.parts, data, binary_size<Bits>);
+    }
+    else {
+        for (size_t i = 0; i < uint_t<Bits>::kParts; i++) {
+            for (size_t k = 0; k < 4; k++) {
+                value.parts[i] |= (uint32_t)data[4 * i + k] << (8 * k);
+            }
+        }
+    }
+    return value;
+}
+
+// Компактный формат: длина в байтах (LEB128), затем значащие байты little-endian.
+// Ноль занимает один байт. Буфер должен вмещать compact_max_size<Bits> байт
+template <size_t Bits>
+inline constexpr size_t compact_max_size = binary_size<Bits> + 3;
+
+template <size_t Bits>
+size_t encode_compact(const uint_t<Bits>& value, uint8_t* out) {
+    size_t parts = uint_t<Bits>::kParts;
+    while (parts > 0 && value.parts[parts - 1] == 0) {
+        parts--;
+    }
+    size_t length = parts == 0 ? 0 : 4 * parts - std::countl_zero(value.parts[parts - 1]) / 8;
+
+    size_t pos = 0;
+    size_t prefix = length;
+    do {
+        uint8_t byte = prefix & 0x7F;
+        prefix >>= 7;
+        out[pos++] = byte | (prefix != 0 ? 0x80 : 0);
+    } while (prefix != 0);
+
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(out + pos, value.parts, length);
+    }
+    else {
+        for (size_t k = 0; k < length; k++) {
+            out[pos + k] = static_cast<uint8_t>(value.parts[k / 4] >> (8 * (k % 4)));
+        }
+    }
+    return pos + length;
+}
+
+// Возвращает число прочитанных байт или 0, если данные обрезаны или число не помещается
+template <size_t Bits>
+size_t decode_compact(const uint8_t* data, size_t size, uint_t<Bits>& value) {
+    size_t pos = 0;
+    size_t length = 0;
+    for (int shift = 0;; shift += 7) {
+        if (pos == size || shift > 28) return 0;
+        uint8_t byte = data[pos++];
+        length |= (size_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) break;
+    }
+    if (length > binary_size<Bits> || size - pos < length) {
+        return 0;
+    }
+    value = uint_t<Bits>();
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(value.parts, data + pos, length);
+    }
+    else {
+        for (size_t k = 0; k < length; k++) {
+            value.parts[k / 4] |= (uint32_t)data[pos + k] << (8 * (k % 4));
+        }
+    }
+    return pos + length;
+}
+
+// Шестнадцатеричная запись без ведущих нулей и префикса, строчными буквами
+template <size_t Bits>
+std::string to_hex(const uint_t<Bits>& value) {
+    size_t size = uint_t<Bits>::kParts;
+    while (size > 1 && value.parts[size - 1] == 0) {
+        size--;
+    }
+    char buffer[uint_t<Bits>::kParts * 8];
+    for (size_t i = 0; i < size; i++) {
+        number_detail::format_hex_word(value.parts[size - 1 - i], buffer + 8 * i);
+    }
+    size_t skip = 0;
+    while (skip < 7 && buffer[skip] == '0') {
+        skip++;
+    }
+    return std::string(buffer + skip, 8 * size - skip);
+}
+
+// Разбор шестнадцатеричной строки (допускается префикс 0x); false при неверном символе,
+// пустой строке или переполнении
+template <size_t Bits>
+bool from_hex(const char* str, size_t len, uint_t<Bits>& value) {
+    if (len >= 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) {
+        str += 2;
+        len -= 2;
+    }
+    if (len == 0) {
+        return false;
+    }
+    while (len > 1 && *str == '0') {
+        str++;
+        len--;
+    }
+    if (len > uint_t<Bits>::kParts * 8) {
+        return false;
+    }
+    uint_t<Bits> result;
+    // Слова разбираются с конца строки по восемь цифр
+    for (size_t i = 0; len > 0; i++) {
+        size_t chunk = std::min<size_t>(len, 8);
+        if (!number_detail::parse_hex_word(str + len - chunk, chunk, result.parts[i])) {
+            return false;
+        }
+        len -= chunk;
+    }
+    value = result;
+    return true;
+}
+
+template <size_t Bits>
+bool from_hex(const std::string& str, uint_t<Bits>& value) {
+    return from_hex(str.data(), str.size(), value);
+}
@@ -0,0 +1,77 @@
+#include <lib/batch.h>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Случайные числа разной длины, включая нули и числа из одних единичных битов
+std::vector<uint2022_t> random_numbers(size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint2022_t> values(count);
+    for (size_t k = 0; k < count; k++) {
+        size_t parts = rng() % 65;
+        for (size_t i = 0; i < parts; i++) {
+            values[k].parts[i] = (k % 7 == 3) ? 0xFFFFFFFF : rng();
+        }
+    }
+    return values;
+}
+
+} // namespace
+
+TEST(BatchTest, RoundTrip) {
+    std::vector<uint2022_t> values = random_numbers(37, 1);
+    uint2022_batch batch(values.data(), values.size());
+
+    ASSERT_EQ(batch.size(), values.size());
+    ASSERT_EQ(batch.to_vector(), values);
+    ASSERT_EQ(batch.get(5), values[5]);
+
+    batch.set(5, from_uint(239));
+    ASSERT_EQ(batch.get(5), from_uint(239));
+}
+
+TEST(BatchTest, MatchesScalarOperators) {
+    std::vector<uint2022_t> lhs = random_numbers(101, 2);
+    std::vector<uint2022_t> rhs = random_numbers(101, 3);
+    uint2022_batch a(lhs.data(), lhs.size());
+    uint2022_batch b(rhs.data(), rhs.size());
+    uint2022_batch sum, diff, product;
+
+    add(a, b, sum);
+    sub(a, b, diff);
+    mul(a, b, product);
+
+    for (size_t k = 0; k < lhs.size(); k++) {
+        ASSERT_EQ(sum.get(k), lhs[k] + rhs[k]) << k;
+        ASSERT_EQ(diff.get(k), lhs[k] - rhs[k]) << k;
+        ASSERT_EQ(product.get(k), lhs[k] * rhs[k]) << k;
+    }
+}
+
+TEST(BatchTest, NarrowOperandsAndAliasing) {
+    std::vector<uint256_t> values(20);
+    for (size_t k = 0; k < values.size(); k++) {
+        values[k] = from_uint<256>(static_cast<uint32_t>(k * 1000003 + 1));
+    }
+    uint_batch<256> batch(values.data(), values.size());
+
+    mul(batch, batch, batch);
+    add(batch, batch, batch);
+
+    for (size_t k = 0; k < values.size(); k++) {
+        ASSERT_EQ(batch.get(k), values[k] * values[k] + values[k] * values[k]);
+    }
+}
+
+#ifndef NDEBUG
+TEST(BatchTest, MismatchedSizesAreRejected) {
+    uint_batch<256> a(4);
+    uint_batch<256> b(5);
+    uint_batch<256> out;
+    EXPECT_DEATH(add(a, b, out), "same size");
+    EXPECT_DEATH(sub(a, b, out), "same size");
+    EXPECT_DEATH(mul(a, b, out), "same size");
+}
+#endif
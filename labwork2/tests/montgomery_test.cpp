@@ -0,0 +1,61 @@
+#include <lib/montgomery.h>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+template <size_t Bits>
+uint_t<Bits> random_below(std::mt19937& rng, const uint_t<Bits>& bound) {
+    uint_t<Bits> value;
+    for (size_t i = 0; i < uint_t<Bits>::kParts; i++) {
+        value.parts[i] = rng();
+    }
+    return value % bound;
+}
+
+// 2^255 - 19
+const uint512_t kPrime255 = from_string<512>("57896044618658097711785492504343953926634992332820282019728792003956564819949");
+
+} // namespace
+
+TEST(MontgomeryTest, MulmodMatchesDivision) {
+    montgomery_context<512> context(kPrime255);
+    std::mt19937 rng(7);
+    for (int i = 0; i < 200; i++) {
+        uint512_t a = random_below(rng, kPrime255);
+        uint512_t b = random_below(rng, kPrime255);
+        ASSERT_EQ(context.mulmod(a, b), a * b % kPrime255);
+        ASSERT_EQ(context.from_montgomery(context.to_montgomery(a)), a);
+    }
+}
+
+TEST(MontgomeryTest, PowmodSmallExponents) {
+    uint512_t modulus = from_string<512>("1000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000007");
+    montgomery_context<512> context(modulus);
+    uint512_t base = from_string<512>("123456789012345678901234567890");
+    uint512_t expected = from_uint<512>(1);
+    for (uint32_t e = 0; e < 100; e++) {
+        ASSERT_EQ(context.powmod(base, from_uint<512>(e)), expected) << e;
+        ASSERT_EQ(context.powmod_consttime(base, from_uint<512>(e)), expected) << e;
+        expected = expected * base % modulus;
+    }
+}
+
+TEST(MontgomeryTest, FermatLittleTheorem) {
+    // 2^521 - 1 - простое число Мерсенна
+    uint2022_t prime = from_uint(1);
+    for (int i = 0; i < 521; i++) {
+        prime = prime + prime;
+    }
+    prime = prime - from_uint(1);
+    montgomery_context<2022> context(prime);
+
+    uint2022_t base = from_string("31415926535897932384626433832795028841971693993751");
+    ASSERT_EQ(context.powmod(base, prime - from_uint(1)), from_uint(1));
+    ASSERT_EQ(context.powmod(base, prime), base);
+    ASSERT_EQ(context.powmod_consttime(base, prime), base);
+
+    montgomery_context<512> small(kPrime255);
+    uint512_t a = from_uint<512>(2);
+    ASSERT_EQ(small.powmod(a, kPrime255 - from_uint<512>(1)), from_uint<512>(1));
+}
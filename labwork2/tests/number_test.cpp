@@ -1,6 +1,10 @@
 #include <lib/number.h>
 #include <gtest/gtest.h>
 #include <tuple>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
 
 class ConvertingTestsSuite : public testing::TestWithParam<std::tuple<uint32_t, const char*, bool>> {
 };
@@ -110,3 +114,196 @@ INSTANTIATE_TEST_SUITE_P(
         )
     )
 );
+
+TEST(FromStringTest, LongNumberRoundTrip) {
+    std::string digits = "1";
+    for (int i = 0; i < 600; i++) {
+        digits += static_cast<char>('0' + (i * 7 + 3) % 10);
+    }
+    std::stringstream stream;
+    stream << from_string(digits.c_str());
+
+    ASSERT_EQ(stream.str(), digits);
+}
+
+TEST(FromStringTest, ChunkBoundaries) {
+    uint2022_t expected = from_uint(0);
+    std::string digits;
+    for (int i = 0; i < 40; i++) {
+        ASSERT_EQ(from_string(digits.c_str()), expected) << digits;
+        digits += static_cast<char>('1' + i % 9);
+        expected = expected * from_uint(10) + from_uint(1 + i % 9);
+    }
+}
+
+TEST(FromStringTest, SkipsNonDigits) {
+    ASSERT_EQ(from_string("1 234 567 890 123 456 789"), from_string("1234567890123456789"));
+    ASSERT_EQ(from_string("12345678a12345678"), from_string("1234567812345678"));
+}
+
+TEST(DivisionTest, QuotientAndRemainder) {
+    uint2022_t a = from_string("1469832487054184013178321496623041557517329857560238757278117847507488415462666081345922349701550571520");
+    uint2022_t b = from_string("3626777458843887524118528");
+    uint2022_t c = from_string("405272312330606683982498447530407677486444946329741974138101544027695953739965");
+
+    ASSERT_EQ(a / b, c);
+    ASSERT_EQ(a % b, from_uint(0));
+    ASSERT_EQ((a + from_uint(12345)) / c, b);
+    ASSERT_EQ((a + from_uint(12345)) % c, from_uint(12345));
+    ASSERT_EQ(from_uint(1000000007) / from_uint(10), from_uint(100000000));
+    ASSERT_EQ(from_uint(1000000007) % from_uint(10), from_uint(7));
+    ASSERT_EQ(b / a, from_uint(0));
+    ASSERT_EQ(b % a, b);
+}
+
+TEST(DivisionTest, MatchesMultiplication) {
+    uint2022_t divisor = from_string("340282366920938463463374607431768211507");
+    uint2022_t value = from_string("9");
+    for (int i = 0; i < 40; i++) {
+        value = value * from_string("1000000000000000000000000000000000037") + from_uint(i);
+        uint2022_t quotient = value / divisor;
+        uint2022_t remainder = value % divisor;
+        ASSERT_EQ(quotient * divisor + remainder, value);
+        ASSERT_NE(remainder / divisor, from_uint(1));
+    }
+}
+
+TEST(CompoundTest, InPlaceOperators) {
+    uint2022_t a = from_string("405272312330606683982498447530407677486444946329741974138101544027695953739965");
+    uint2022_t b = from_string("3626777458843887524118528");
+    uint2022_t value = a;
+
+    value += b;
+    ASSERT_EQ(value, a + b);
+    value -= b;
+    ASSERT_EQ(value, a);
+    value *= b;
+    ASSERT_EQ(value, a * b);
+    value /= b;
+    ASSERT_EQ(value, a);
+    value %= b;
+    ASSERT_EQ(value, a % b);
+    value *= value;
+    ASSERT_EQ(value, (a % b) * (a % b));
+}
+
+TEST(ExpressionTest, MultiplyAccumulateChain) {
+    uint2022_t a = from_string("340282366920938463463374607431768211507");
+    uint2022_t b = from_string("18446744073709551629");
+    uint2022_t c = from_string("4294967311");
+    uint2022_t d = from_string("98765432109876543210");
+    uint2022_t e = from_string("123456789");
+
+    uint2022_t result;
+    result = mul(a, b) + mul(c, d) - e;
+    ASSERT_EQ(result, a * b + c * d - e);
+
+    uint2022_t acc = e;
+    acc += mul(a, b);
+    acc -= mul(c, d);
+    ASSERT_EQ(acc, e + a * b - c * d);
+
+    acc = mul(acc, c) + acc;
+    ASSERT_EQ(acc, (e + a * b - c * d) * c + (e + a * b - c * d));
+}
+
+TEST(WidthTest, CompileTimeConstants) {
+    constexpr uint256_t a = from_string<256>("115792089237316195423570985008687907853269984665640564039457584007913129639935");
+    constexpr uint256_t b = from_uint<256>(1);
+    static_assert(a + b == uint256_t());
+    static_assert(a * a == b);
+    static_assert((a - b) / from_uint<256>(2) == from_string<256>("57896044618658097711785492504343953926634992332820282019728792003956564819967"));
+    static_assert(sizeof(uint256_t) == 32 && sizeof(uint512_t) == 64 && sizeof(uint4096_t) == 512);
+}
+
+TEST(WidthTest, WideArithmetic) {
+    uint4096_t value = from_uint<4096>(1);
+    for (int i = 0; i < 1000; i++) {
+        value *= from_uint<4096>(3);
+    }
+    uint4096_t quotient = value;
+    for (int i = 0; i < 999; i++) {
+        quotient /= from_uint<4096>(3);
+    }
+    ASSERT_EQ(quotient, from_uint<4096>(3));
+    ASSERT_EQ(value % from_uint<4096>(3), uint4096_t());
+}
+
+TEST(BitwiseTest, ShiftsMatchPowersOfTwo) {
+    uint2022_t value = from_string("405272312330606683982498447530407677486444946329741974138101544027695953739965");
+    uint2022_t power = from_uint(1);
+    for (size_t shift = 0; shift < 700; shift += 13) {
+        ASSERT_EQ(value << shift, value * power) << shift;
+        ASSERT_EQ((value * power) >> shift, value) << shift;
+        ASSERT_EQ(value >> shift, value / power) << shift;
+        for (int i = 0; i < 13; i++) {
+            power = power + power;
+        }
+    }
+    ASSERT_EQ(value << 2048, uint2022_t());
+    ASSERT_EQ(value >> 2048, uint2022_t());
+    ASSERT_EQ(value << 0, value);
+    ASSERT_EQ((value << 64) >> 64, value);
+}
+
+TEST(BitwiseTest, LogicalOperators) {
+    uint2022_t a = from_string("340282366920938463463374607431768211455"); // 2^128 - 1
+    uint2022_t b = from_uint(1) << 100;
+
+    ASSERT_EQ(a & b, b);
+    ASSERT_EQ(a | b, a);
+    ASSERT_EQ(a ^ b, a - b);
+    ASSERT_EQ(~uint2022_t() + from_uint(1), uint2022_t());
+    ASSERT_EQ(~a & a, uint2022_t());
+
+    uint2022_t c = a;
+    c &= b;
+    c |= from_uint(5);
+    c ^= from_uint(1);
+    ASSERT_EQ(c, b + from_uint(4));
+}
+
+TEST(CompareTest, ThreeWayComparison) {
+    uint2022_t small = from_string("3626777458843887524118528");
+    uint2022_t big = from_string("405272312330606683982498447530407677486444946329741974138101544027695953739965");
+
+    ASSERT_TRUE(small < big);
+    ASSERT_TRUE(big > small);
+    ASSERT_TRUE(small <= small);
+    ASSERT_TRUE(big >= small);
+    ASSERT_TRUE((small <=> small) == 0);
+    ASSERT_TRUE(from_uint(1) << 64 > (from_uint(1) << 63));
+    ASSERT_TRUE(big - from_uint(1) < big);
+    static_assert(from_uint<256>(7) < from_uint<256>(8));
+}
+
+TEST(DivisorTest, QuotientTimesDivisorPlusRemainder) {
+    uint2022_t value = from_string("1469832487054184013178321496623041557517329857560238757278117847507488415462666081345922349701550571520");
+    std::mt19937_64 rng(11);
+    std::vector<uint64_t> divisors = {
+        1, 3, 10, 1000000000, 4294967295, 4294967296, 4294967311, 18446744073709551557ull, 18446744073709551615ull
+    };
+    for (int i = 0; i < 200; i++) {
+        divisors.push_back(rng() >> (rng() % 64) | 1);
+    }
+    for (uint64_t d : divisors) {
+        uint2022_t wide_d = from_uint(static_cast<uint32_t>(d)) + (from_uint(static_cast<uint32_t>(d >> 32)) << 32);
+        uint2022_t quotient;
+        uint64_t remainder = divmod(value, invariant_divisor(d), quotient);
+        uint2022_t wide_r = from_uint(static_cast<uint32_t>(remainder)) + (from_uint(static_cast<uint32_t>(remainder >> 32)) << 32);
+        ASSERT_LT(remainder, d);
+        ASSERT_EQ(quotient * wide_d + wide_r, value) << d;
+    }
+}
+
+TEST(DivisorTest, PrintsPowersOfTen) {
+    uint2022_t value = from_uint(1);
+    std::string expected = "1";
+    for (int i = 0; i < 600; i++) {
+        std::stringstream stream;
+        stream << value;
+        ASSERT_EQ(stream.str(), expected);
+        value = value * from_uint(10);
+        expected += '0';
+    }
+}
@@ -0,0 +1,70 @@
+#include <lib/product.h>
+#include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+TEST(ProductTest, KaratsubaMatchesSchoolbook) {
+    std::mt19937 rng(5);
+    for (size_t limbs : {1, 23, 24, 25, 64, 100, 255, 256}) {
+        uint_t<16384> a;
+        uint_t<16384> b;
+        for (size_t i = 0; i < limbs; i++) {
+            a.parts[i] = rng();
+            b.parts[i] = (i % 5 == 0) ? 0xFFFFFFFF : rng();
+        }
+        uint_t<16384> result;
+        ASSERT_FALSE(mul_checked(a, b, result)) << limbs;
+        ASSERT_EQ(result, a * b) << limbs;
+    }
+}
+
+TEST(ProductTest, OverflowIsReported) {
+    uint2022_t half = from_uint(1) << 1010;
+    uint2022_t result;
+    ASSERT_FALSE(mul_checked(half, half, result));
+    ASSERT_EQ(result, from_uint(1) << 2020);
+    ASSERT_TRUE(mul_checked(half, half << 2, result));
+
+    ASSERT_FALSE(factorial(297).overflow);
+    ASSERT_TRUE(factorial(298).overflow);
+}
+
+TEST(ProductTest, FactorialMatchesSequentialProduct) {
+    uint_t<16384> expected = from_uint<16384>(1);
+    for (uint32_t i = 2; i <= 1000; i++) {
+        expected *= from_uint<16384>(i);
+    }
+    for (unsigned threads : {1u, 3u, 8u}) {
+        product_result<16384> result = factorial<16384>(1000, threads);
+        ASSERT_FALSE(result.overflow);
+        ASSERT_EQ(result.value, expected) << threads;
+    }
+    ASSERT_EQ(factorial(0).value, from_uint(1));
+    ASSERT_EQ(factorial(20).value, from_string("2432902008176640000"));
+}
+
+TEST(ProductTest, ProductOfSequence) {
+    std::vector<uint2022_t> values;
+    uint2022_t expected = from_uint(1);
+    for (uint32_t i = 0; i < 90; i++) {
+        values.push_back(from_uint(i * 7919 + 3));
+        expected *= values.back();
+    }
+    product_result<2022> result = product(values.data(), values.size(), 4);
+    ASSERT_FALSE(result.overflow);
+    ASSERT_EQ(result.value, expected);
+    ASSERT_EQ(product(values.data(), 0).value, from_uint(1));
+}
+
+TEST(ProductTest, LeafExceptionIsRethrown) {
+    auto leaf = [](size_t first, size_t last) {
+        if (first <= 100 && 100 < last) {
+            throw std::runtime_error("leaf failed");
+        }
+        return product_result<2022>{ from_uint(1), false };
+    };
+    for (unsigned threads : {2u, 5u, 8u}) {
+        EXPECT_THROW((number_detail::parallel_product<2022>(256, leaf, threads)), std::runtime_error) << threads;
+    }
+}
@@ -0,0 +1,62 @@
+#include <lib/serialize.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+
+const uint2022_t kValue = from_string("405272312330606683982498447530407677486444946329741974138101544027695953739965");
+
+} // namespace
+
+TEST(SerializeTest, FixedBinaryRoundTrip) {
+    uint8_t bytes[binary_size<2022>];
+    to_bytes(kValue, bytes);
+
+    ASSERT_EQ(bytes[0], kValue.parts[0] & 0xFF);
+    ASSERT_EQ(from_bytes<2022>(bytes), kValue);
+}
+
+TEST(SerializeTest, CompactRoundTrip) {
+    uint8_t buffer[compact_max_size<2022>];
+
+    ASSERT_EQ(encode_compact(uint2022_t(), buffer), 1u);
+    ASSERT_EQ(encode_compact(from_uint(255), buffer), 2u);
+    ASSERT_EQ(encode_compact(from_uint(256), buffer), 3u);
+
+    uint2022_t all_ones = ~uint2022_t();
+    for (const uint2022_t& value : { uint2022_t(), from_uint(256), kValue, all_ones }) {
+        size_t size = encode_compact(value, buffer);
+        uint2022_t decoded;
+        ASSERT_EQ(decode_compact(buffer, size, decoded), size);
+        ASSERT_EQ(decoded, value);
+        ASSERT_EQ(decode_compact(buffer, size - 1, decoded), 0u);
+    }
+}
+
+TEST(SerializeTest, HexRoundTrip) {
+    ASSERT_EQ(to_hex(uint2022_t()), "0");
+    ASSERT_EQ(to_hex(from_uint(0xABCDEF)), "abcdef");
+    ASSERT_EQ(to_hex(from_uint(1) << 64), "10000000000000000");
+
+    uint2022_t parsed;
+    ASSERT_TRUE(from_hex(to_hex(kValue), parsed));
+    ASSERT_EQ(parsed, kValue);
+    ASSERT_TRUE(from_hex(std::string("0xDeadBeef00000001"), parsed));
+    ASSERT_EQ(parsed, (from_uint(0xDEADBEEF) << 32) + from_uint(1));
+    ASSERT_TRUE(from_hex(std::string("000000000000000000000000001"), parsed));
+    ASSERT_EQ(parsed, from_uint(1));
+}
+
+TEST(SerializeTest, HexRejectsInvalidInput) {
+    uint2022_t parsed = from_uint(7);
+    ASSERT_FALSE(from_hex(std::string(""), parsed));
+    ASSERT_FALSE(from_hex(std::string("0x"), parsed));
+    ASSERT_FALSE(from_hex(std::string("12g4"), parsed));
+    ASSERT_FALSE(from_hex(std::string(513, 'f'), parsed));
+    ASSERT_EQ(parsed, from_uint(7));
+
+    uint256_t narrow;
+    ASSERT_TRUE(from_hex(std::string(64, 'f'), narrow));
+    ASSERT_EQ(narrow, ~uint256_t());
+    ASSERT_FALSE(from_hex(std::string(65, 'f'), narrow));
+}
@@ -0,0 +1,197 @@
+// Замеры решателей на стандартных сценариях. Для каждого сценария модель считается
+// до устойчивого состояния, печатаются время, число обвалов в секунду, пиковая
+// память процесса и объем записанных картинок.
+//
+//   sandpile_bench [--scenario pile|random|scattered|max-stable|all] [-k N] [-f N]
+//                  [--mode ...] [--bulk] [-t N] [--encoders N] [--bmp24] [-o DIR]
+//
+// Масштаб сценариев - 2^k песчинок (по умолчанию k = 16). -f - частота картинок,
+// как у sandpile_model; при 0 пишется только последний кадр. Картинки сценария
+// пишутся в DIR/<сценарий>, без -o - во временный каталог, который потом удаляется.
+// Остальные флаги выбирают решатель так же, как у sandpile_model.
+#include "config.h"
+#include "grid.h"
+#include "sandpile.h"
+#include "snapshot.h"
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Scenario {
+    std::string name;
+    Grid (*build)(int k);
+};
+
+// Одна куча из 2^k песчинок на поле 1x1
+Grid centralPile(int k) {
+    Grid grid = makeGrid(0, 0, 0, 0);
+    grid.at(0, 0) = uint64_t(1) << k;
+    return grid;
+}
+
+// Поле 2^(k/2) x 2^(k/2), в каждой клетке равномерно от 0 до 7 песчинок
+Grid uniformRandom(int k) {
+    const int side = 1 << (k / 2);
+    Grid grid = makeGrid(0, side - 1, 0, side - 1);
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<uint64_t> grains(0, 7);
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            grid.at(x, y) = grains(random);
+        }
+    }
+    return grid;
+}
+
+// 64 кучи по 2^(k-6) песчинок в случайных клетках поля 2^(k/2+2) x 2^(k/2+2)
+Grid scatteredPiles(int k) {
+    const int side = 1 << (k / 2 + 2);
+    Grid grid = makeGrid(0, side - 1, 0, side - 1);
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<int> coordinate(0, side - 1);
+    for (int i = 0; i < 64; ++i) {
+        grid.at(coordinate(random), coordinate(random)) += uint64_t(1) << (k - 6);
+    }
+    return grid;
+}
+
+// Поле 2^(k/2) x 2^(k/2) из троек - самое тяжелое устойчивое - и одна песчинка в центре
+Grid maxStablePlusOne(int k) {
+    const int side = 1 << (k / 2);
+    Grid grid = makeGrid(0, side - 1, 0, side - 1);
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            grid.at(x, y) = 3;
+        }
+    }
+    grid.at(side / 2, side / 2) += 1;
+    return grid;
+}
+
+const std::vector<Scenario> kScenarios = {
+    { "pile", centralPile },
+    { "random", uniformRandom },
+    { "scattered", scatteredPiles },
+    { "max-stable", maxStablePlusOne },
+};
+
+// Пиковая память процесса (VmHWM), КБ
+uint64_t peakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::stoull(line.substr(6));
+        }
+    }
+    return 0;
+}
+
+// Сбрасывает VmHWM до текущей памяти, чтобы пик считался для каждого сценария отдельно
+void resetPeakRss() {
+    std::ofstream clear("/proc/self/clear_refs");
+    clear << "5";
+}
+
+uint64_t directoryBytes(const fs::path& dir) {
+    uint64_t bytes = 0;
+    for (const fs::directory_entry& entry : fs::directory_iterator(dir)) {
+        bytes += entry.file_size();
+    }
+    return bytes;
+}
+
+// Картинки сценария пишутся в base / имя сценария
+void run(const Scenario& scenario, int k, const Config& config, const fs::path& base) {
+    const fs::path output = base / scenario.name;
+    fs::remove_all(output);
+    fs::create_directories(output);
+    resetPeakRss();
+
+    Grid grid = scenario.build(k);
+    const Bounds initial = grid;
+    std::unique_ptr<SandpileSolver> solver = makeSolver(config, std::move(grid));
+
+    uint64_t iter = 0;
+    const auto start = std::chrono::steady_clock::now();
+    {
+        SnapshotWriter writer(config.encoders, config.bmp24 ? BmpFormat::Rgb24 : BmpFormat::Palette4);
+        bool stable = false;
+        while (!stable) {
+            stable = !solver->step();
+            if ((config.freq > 0 && iter % config.freq == 0) || stable) {
+                writer.submit(*solver, (output / ("iter_" + std::to_string(iter) + ".bmp")).string(), iter);
+            }
+            iter++;
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const Bounds final_bounds = solver->bounds();
+    const uint64_t topplings = solver->topplings();
+    std::cout << std::left << std::setw(12) << scenario.name << std::right
+        << std::setw(12) << (std::to_string(initial.width()) + "x" + std::to_string(initial.height()))
+        << std::setw(12) << (std::to_string(final_bounds.width()) + "x" + std::to_string(final_bounds.height()))
+        << std::setw(10) << iter
+        << std::setw(10) << std::fixed << std::setprecision(3) << seconds
+        << std::setw(14) << topplings
+        << std::setw(12) << std::setprecision(1) << (seconds > 0 ? topplings / seconds / 1e6 : 0.0)
+        << std::setw(10) << peakRssKb() / 1024.0
+        << std::setw(14) << directoryBytes(output)
+        << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Config config = parseArgs(argc, argv);
+    std::string only = "all";
+    int k = 16;
+    for (int i = 1; i + 1 < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--scenario") {
+            only = argv[++i];
+        }
+        else if (arg == "-k") {
+            k = std::stoi(argv[++i]);
+        }
+    }
+    if (k < 6 || k > 40) {
+        std::cerr << "k must be in [6, 40]" << std::endl;
+        return 1;
+    }
+    const bool temporary = config.output_dir.empty();
+    const fs::path output = temporary ? fs::temp_directory_path() / "sandpile_bench" : fs::path(config.output_dir);
+
+    std::cout << std::left << std::setw(12) << "scenario" << std::right
+        << std::setw(12) << "initial" << std::setw(12) << "final"
+        << std::setw(10) << "iters" << std::setw(10) << "seconds"
+        << std::setw(14) << "topplings" << std::setw(12) << "Mtopple/s"
+        << std::setw(10) << "peak MB" << std::setw(14) << "bmp bytes" << std::endl;
+    bool found = false;
+    for (const Scenario& scenario : kScenarios) {
+        if (only == "all" || only == scenario.name) {
+            found = true;
+            run(scenario, k, config, output);
+        }
+    }
+    if (!found) {
+        std::cerr << "Unknown scenario: " << only << std::endl;
+        return 1;
+    }
+    if (temporary) {
+        fs::remove_all(output);
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "grid.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Анимация - все кадры расчета в одном файле вместо картинки на кадр.
+// Файл: 8 байт "SANDANI1", затем кадры подряд. Кадр: байт типа (ключевой или разностный),
+// номер итерации (8 байт), границы поля (4 x 4 байта), длина данных (8 байт), данные.
+// Все числа little-endian. Данные - уровни цвета клеток (0-4) по строкам, сжатые
+// по сериям: серии из одного значения пишутся длиной и значением, остальное - по
+// полбайта на клетку. В ключевом кадре сжимаются сами уровни, в разностном - XOR с
+// предыдущим кадром, перенесенным в границы текущего (клетки вне прежних границ
+// считаются нулевыми). Между кадрами меняется малая часть клеток, так что разностный
+// кадр - в основном длинные серии нулей. Каждый kKeyframeInterval-й кадр ключевой,
+// чтобы любой кадр восстанавливался не дольше чем за kKeyframeInterval шагов.
+struct AnimationFrame {
+    uint64_t iteration = 0;
+    Bounds bounds = { 0, -1, 0, -1 };
+    std::vector<uint8_t> levels; // bounds.width() * bounds.height() уровней по строкам
+};
+
+class AnimationWriter {
+public:
+    static constexpr uint64_t kKeyframeInterval = 256;
+
+    explicit AnimationWriter(const std::string& path);
+
+    AnimationWriter(const AnimationWriter&) = delete;
+    AnimationWriter& operator=(const AnimationWriter&) = delete;
+
+    // Кадры добавляются по порядку итераций
+    void append(uint64_t iteration, const Bounds& bounds, const std::vector<uint8_t>& levels);
+
+private:
+    std::ofstream file_;
+    std::string path_;
+    uint64_t frames_ = 0;
+    AnimationFrame previous_;
+    std::vector<uint8_t> delta_;
+    std::vector<uint8_t> packed_;
+};
+
+// Чтение анимации: при открытии файл просматривается по заголовкам кадров,
+// данные читаются только при восстановлении кадра
+class AnimationReader {
+public:
+    struct Entry {
+        uint64_t iteration;
+        Bounds bounds;
+        bool keyframe;
+        uint64_t offset; // начало данных кадра в файле
+        uint64_t size;
+    };
+
+    // При ошибке завершает программу
+    explicit AnimationReader(const std::string& path);
+
+    const std::vector<Entry>& entries() const { return entries_; }
+
+    // Кадр номер index в файле: от ближайшего ключевого кадра применяются разности
+    AnimationFrame frame(size_t index);
+
+private:
+    std::ifstream file_;
+    std::string path_;
+    std::vector<Entry> entries_;
+};
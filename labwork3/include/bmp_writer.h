@@ -1,5 +1,15 @@
 #pragma once
 #include "grid.h"
+#include <functional>
 #include <string>
 
-void saveBMP(const Grid& grid, const std::string& path, int iteration);
\ No newline at end of file
+enum class BmpFormat {
+    Palette4, // 4 бита на точку, палитра из 5 цветов
+    Rgb24,    // 24 бита на точку
+};
+
+// Источник строк картинки: заполняет bounds.width() уровней цвета (0-4, больше 3
+// песчинок - 4) строки y (от 0)
+using LevelReader = std::function<void(size_t y, uint8_t* out)>;
+
+void saveBMP(const Bounds& bounds, const LevelReader& row, const std::string& path, BmpFormat format);
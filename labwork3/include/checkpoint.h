@@ -0,0 +1,69 @@
+#pragma once
+#include "grid.h"
+#include "sandpile.h"
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Контрольная точка - состояние поля на диске, с которого можно продолжить расчет.
+// Файл: заголовок CheckpointHeader, за ним width * height клеток по строкам (y от 0),
+// каждая по cell_bytes байт в порядке little-endian. cell_bytes - наименьшая ширина
+// из 1, 2, 4, 8, в которую влезает самая большая клетка. Заголовок кратен 8 байтам,
+// так что отображенный в память файл можно читать без копирования.
+struct CheckpointHeader {
+    char magic[8];       // "SANDPCK1"
+    uint32_t version;
+    uint32_t cell_bytes;
+    int32_t min_x, max_x;
+    int32_t min_y, max_y;
+    uint64_t iteration;  // сколько итераций уже сделано
+};
+
+struct Checkpoint {
+    Grid grid;
+    uint64_t iteration;
+};
+
+// Читает контрольную точку через mmap; при ошибке завершает программу
+Checkpoint loadCheckpoint(const std::string& path);
+
+// Периодическая запись контрольных точек. submit() берет у решателя снимок поля
+// (SandpileSolver::snapshot: у Sync и Narrow это отданный буфер поколения, без копирования),
+// а фоновый поток пишет его в path.tmp, делает fsync и переименовывает в path, так что
+// на диске всегда лежит целая точка. Пока предыдущая точка пишется, новые пропускаются.
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(std::string path);
+    // Дожидается записи последней точки
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    // false, если точка пропущена из-за незаконченной предыдущей
+    bool submit(SandpileSolver& solver, uint64_t iteration);
+    // Ждет окончания текущей записи и, если точки на iteration еще нет, пишет ее сразу
+    void finish(const SandpileSolver& solver, uint64_t iteration);
+
+private:
+    void work();
+
+    std::string path_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    // Снимок для фонового потока; пока pending_, его трогает только поток
+    std::unique_ptr<FieldSnapshot> field_;
+    uint64_t iteration_ = 0;
+    bool pending_ = false;
+    bool stop_ = false;
+    uint64_t last_ = 0;
+    bool written_ = false;
+    // Последним, чтобы поток стартовал после всех полей
+    std::thread thread_;
+};
+
+// Пишет контрольную точку сразу, в вызывающем процессе; false при ошибке
+bool saveCheckpoint(const SandpileSolver& solver, uint64_t iteration, const std::string& path);
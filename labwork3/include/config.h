@@ -2,6 +2,14 @@
 #include <string>
 #include <cstdint>
 
+// Способ пересчета модели
+enum class SolverMode {
+    Sync,     // все клетки поколения осыпаются одновременно
+    Worklist, // осыпаются только клетки из очереди неустойчивых
+    Narrow,   // как Sync, но на байтовых клетках с векторным проходом
+    Tiled,    // как Sync, но на разреженном поле из плиток
+};
+
 struct Config {
     uint16_t length;
     uint16_t width;
@@ -9,6 +17,17 @@ struct Config {
     std::string output_dir;
     uint64_t max_iter;
     uint64_t freq;
+    SolverMode mode;
+    bool bulk; // клетка осыпается сразу на value / 4 песчинок каждому соседу
+    unsigned threads; // потоков для синхронного режима; 0 - по числу ядер
+    unsigned encoders; // фоновых потоков записи картинок; 0 - писать сразу
+    bool bmp24; // картинки в 24 бита на точку вместо 4-битной палитры
+    std::string checkpoint_file; // куда писать контрольные точки; пусто - не писать
+    uint64_t checkpoint_freq; // раз в сколько итераций; 0 - только в конце
+    std::string resume_file; // контрольная точка, с которой продолжить расчет
+    std::string stats_file; // куда писать ход расчета; пусто - не писать
+    uint64_t stats_freq; // раз в сколько итераций
+    std::string animation_file; // кадры в один файл анимации вместо картинок
 };
 
 Config parseArgs(int argc, char** argv);
\ No newline at end of file
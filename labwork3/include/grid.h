@@ -1,12 +1,192 @@
 #pragma once
 #include "config.h"
+#include <algorithm>
 #include <vector>
 #include <cstdint>
+#include <cstddef>
 
-struct Grid {
+// Границы поля в координатах модели, включительно
+struct Bounds {
     int min_x, max_x;
     int min_y, max_y;
-    std::vector<std::vector<uint64_t>> data;
+
+    size_t width() const { return max_x - min_x + 1; }
+    size_t height() const { return max_y - min_y + 1; }
+};
+
+// Начальная клетка из входного файла
+struct Seed {
+    uint16_t x, y;
+    uint64_t value;
+};
+
+// Поле хранится одним массивом по строкам с рамкой в одну клетку вокруг:
+// рамка всегда нулевая, поэтому соседей можно читать без проверок границ.
+// Хранилище может быть больше поля с рамкой - это запас для роста во все стороны.
+// Клетки хранилища вне поля всегда нулевые.
+template <typename Cell>
+struct BasicGrid : Bounds {
+    std::vector<Cell> data;
+    size_t pitch = 0;  // длина строки хранилища
+    size_t origin = 0; // индекс клетки (0, 0) в хранилище
+
+    size_t stride() const { return pitch; }
+
+    // x, y - координаты внутри поля, от 0
+    size_t index(size_t x, size_t y) const { return origin + y * pitch + x; }
+    Cell& at(size_t x, size_t y) { return data[index(x, y)]; }
+    Cell at(size_t x, size_t y) const { return data[index(x, y)]; }
+};
+
+using Grid = BasicGrid<uint64_t>;
+
+// Запас хранилища с каждой стороны поля, в клетках
+struct Spare {
+    size_t left = 0, right = 0;
+    size_t top = 0, bottom = 0;
+};
+
+// Пустое поле с заданными границами; хранилище с запасом spare (по умолчанию без запаса)
+template <typename Cell = uint64_t>
+BasicGrid<Cell> makeGrid(int min_x, int max_x, int min_y, int max_y, const Spare& spare = Spare()) {
+    BasicGrid<Cell> grid;
+    grid.min_x = min_x;
+    grid.max_x = max_x;
+    grid.min_y = min_y;
+    grid.max_y = max_y;
+    grid.pitch = grid.width() + 2 + spare.left + spare.right;
+    grid.origin = (spare.top + 1) * grid.pitch + spare.left + 1;
+    grid.data.assign(grid.pitch * (grid.height() + 2 + spare.top + spare.bottom), 0);
+    return grid;
+}
+
+// Приводит target к расположению source: те же границы, то же хранилище.
+// Содержимое target сохраняется, только если source - то же хранилище, выросшее на месте:
+// прежние клетки target лежат там же, где у source, а все вне их - нули. Иначе (в том числе
+// когда growGrid выделил новое хранилище того же размера) target обнуляется
+template <typename Cell, typename Other>
+void matchLayout(BasicGrid<Cell>& target, const BasicGrid<Other>& source) {
+    const bool grown_in_place = target.pitch == source.pitch && target.data.size() == source.data.size()
+        && target.min_x >= source.min_x && target.max_x <= source.max_x
+        && target.min_y >= source.min_y && target.max_y <= source.max_y
+        && target.origin == source.origin + size_t(target.min_y - source.min_y) * source.pitch
+            + size_t(target.min_x - source.min_x);
+    if (!grown_in_place) {
+        target.data.assign(source.data.size(), 0);
+    }
+    target.min_x = source.min_x;
+    target.max_x = source.max_x;
+    target.min_y = source.min_y;
+    target.max_y = source.max_y;
+    target.pitch = source.pitch;
+    target.origin = source.origin;
+}
+
+// Пересчет индексов хранилища, взятых до growGrid. Если хранилище не менялось,
+// индексы остаются прежними
+struct GridRemap {
+    bool moved = false;
+    size_t old_pitch = 0;
+    size_t old_origin = 0;
+    size_t new_pitch = 0;
+    size_t new_origin = 0; // новый индекс бывшей клетки (0, 0)
+
+    size_t operator()(size_t index) const {
+        if (!moved) {
+            return index;
+        }
+        // Смещения могут быть "отрицательными" для рамки: арифметика по модулю 2^64 это допускает
+        size_t dy = index / old_pitch - old_origin / old_pitch;
+        size_t dx = index % old_pitch - old_origin % old_pitch;
+        return new_origin + dy * new_pitch + dx;
+    }
 };
 
-Grid loadInitialGrid(const Config& config);
+// Хватит ли запаса, чтобы growGrid расширил поле на месте, без нового хранилища
+template <typename Cell>
+bool growsInPlace(const BasicGrid<Cell>& grid, int left, int right, int top, int bottom) {
+    const size_t column = grid.origin % grid.pitch;
+    const size_t row = grid.origin / grid.pitch;
+    const size_t width = grid.width() + left + right;
+    const size_t height = grid.height() + top + bottom;
+    return column > static_cast<size_t>(left) && row > static_cast<size_t>(top)
+        && column - left + width < grid.pitch && row - top + height < grid.data.size() / grid.pitch;
+}
+
+// Расширяет поле на заданное число клеток с каждой стороны, сохраняя содержимое.
+// Пока хватает запаса, только сдвигаются границы; иначе хранилище выделяется заново
+// с запасом в четверть размера с каждой стороны, так что рост в среднем стоит O(1)
+template <typename Cell>
+GridRemap growGrid(BasicGrid<Cell>& grid, int left, int right, int top, int bottom) {
+    const size_t width = grid.width() + left + right;
+    const size_t height = grid.height() + top + bottom;
+    GridRemap remap;
+    if (growsInPlace(grid, left, right, top, bottom)) {
+        // Песчинки, упавшие в рамку, уже лежат в новых клетках
+        grid.origin -= top * grid.pitch + left;
+    }
+    else {
+        const size_t slack_x = std::max<size_t>(width / 4, 4);
+        const size_t slack_y = std::max<size_t>(height / 4, 4);
+        BasicGrid<Cell> grown;
+        grown.pitch = width + 2 + 2 * slack_x;
+        grown.origin = (slack_y + 1) * grown.pitch + slack_x + 1;
+        grown.data.assign(grown.pitch * (height + 2 + 2 * slack_y), 0);
+        // Копируется и рамка: песчинки, упавшие в нее, оказываются в новых клетках
+        const size_t first = grid.origin - grid.pitch - 1;
+        const size_t target = grown.origin + top * grown.pitch + left - grown.pitch - 1;
+        for (size_t y = 0; y < grid.height() + 2; ++y) {
+            const Cell* src = &grid.data[first + y * grid.pitch];
+            std::copy(src, src + grid.width() + 2, &grown.data[target + y * grown.pitch]);
+        }
+        remap = { true, grid.pitch, grid.origin, grown.pitch, grown.origin + top * grown.pitch + left };
+        grid.data = std::move(grown.data);
+        grid.pitch = grown.pitch;
+        grid.origin = grown.origin;
+    }
+    grid.min_x -= left;
+    grid.max_x += right;
+    grid.min_y -= top;
+    grid.max_y += bottom;
+    return remap;
+}
+
+// Копирует строку y поля (от 0) в out
+template <typename Cell>
+void readGridRow(const BasicGrid<Cell>& grid, size_t y, uint64_t* out) {
+    const Cell* cells = &grid.data[grid.index(0, y)];
+    std::copy(cells, cells + grid.width(), out);
+}
+
+// Стороны, на краю которых есть клетки с >= 4 песчинками: песчинки упадут за границу
+template <typename Cell>
+bool unstableSides(const BasicGrid<Cell>& grid, int& left, int& right, int& top, int& bottom) {
+    const size_t width = grid.width();
+    const size_t height = grid.height();
+    left = right = top = bottom = 0;
+    for (size_t x = 0; x < width; ++x) {
+        top |= grid.at(x, 0) >= 4;
+        bottom |= grid.at(x, height - 1) >= 4;
+    }
+    for (size_t y = 0; y < height; ++y) {
+        left |= grid.at(0, y) >= 4;
+        right |= grid.at(width - 1, y) >= 4;
+    }
+    return (left | right | top | bottom) != 0;
+}
+
+// Границы поля из аргументов и клетки входного файла
+Bounds initialBounds(const Config& config);
+std::vector<Seed> loadSeeds(const Config& config);
+
+// Запас, в который по оценке уложится устойчивое состояние начальных клеток seeds
+// (или клеток готового поля, например из контрольной точки). cell_bytes - ширина клетки
+// решателя: запас ограничен по памяти, так что байтовым клеткам его достается больше
+Spare predictSpare(const Bounds& bounds, const std::vector<Seed>& seeds, size_t cell_bytes = sizeof(uint64_t));
+Spare predictSpare(const Grid& grid, size_t cell_bytes = sizeof(uint64_t));
+
+// Поле из начальных клеток с запасом хранилища spare
+Grid makeInitialGrid(const Bounds& bounds, const std::vector<Seed>& seeds, const Spare& spare = Spare());
+
+// То же поле с запасом не меньше spare; если его уже хватает, поле не копируется
+Grid reserveSpare(Grid grid, const Spare& spare);
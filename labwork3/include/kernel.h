@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Следующее поколение строки; возвращает число обвалов в строке (0 - строка устойчива).
+// Bulk: клетка отдает каждому соседу value / 4 песчинок и оставляет value % 4,
+// это считается за value / 4 обвалов
+template <bool Bulk>
+inline uint64_t sweepRow(const uint64_t* src, uint64_t* dst, size_t width, size_t stride) {
+    uint64_t topplings = 0;
+    for (size_t x = 0; x < width; ++x) {
+        uint64_t value = src[x];
+        if constexpr (Bulk) {
+            topplings += value >> 2;
+            dst[x] = (value & 3)
+                + (src[x - 1] >> 2) + (src[x + 1] >> 2)
+                + (src[x - stride] >> 2) + (src[x + stride] >> 2);
+        }
+        else {
+            uint64_t self = value >= 4;
+            topplings += self;
+            dst[x] = value - 4 * self
+                + (src[x - 1] >= 4) + (src[x + 1] >= 4)
+                + (src[x - stride] >= 4) + (src[x + stride] >= 4);
+        }
+    }
+    return topplings;
+}
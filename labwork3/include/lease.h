@@ -0,0 +1,103 @@
+#pragma once
+#include "grid.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+// Поле на какой-то итерации, которое можно читать из другого потока, пока решатель
+// считает дальше (см. SandpileSolver::snapshot)
+class FieldSnapshot {
+public:
+    virtual ~FieldSnapshot() = default;
+
+    virtual Bounds bounds() const = 0;
+    // Строка y поля (от 0): bounds().width() значений
+    virtual void readRow(size_t y, uint64_t* out) const = 0;
+};
+
+// Буфер поколения, отданный снимку на чтение. Решатель и дальше читает этот буфер,
+// но не пишет в него и не освобождает, пока снимок жив: перед записью во второй буфер
+// поколения вызывается reclaim(), перед ростом поля с новым хранилищем - detach().
+// Отданный буфер уходит в запас и, когда снимок его отпустит, снова идет в дело,
+// так что в установившемся режиме снимки ничего не выделяют
+template <typename Cell>
+class GridLease {
+public:
+    GridLease() = default;
+    // Снимок переживает решатель только на время записи: его дожидаются
+    ~GridLease() {
+        while (busy()) {
+            std::this_thread::yield();
+        }
+    }
+
+    GridLease(const GridLease&) = delete;
+    GridLease& operator=(const GridLease&) = delete;
+
+    // Отданный буфер еще читают; второй снимок в это время придется копировать
+    bool busy() const { return released_ != nullptr && !released_->load(std::memory_order_acquire); }
+
+    // Отдает буфер grid; снимок поднимает флаг, когда отпускает его
+    std::shared_ptr<std::atomic<bool>> lend(const BasicGrid<Cell>& grid) {
+        released_ = std::make_shared<std::atomic<bool>>(false);
+        lent_ = grid.data.data();
+        return released_;
+    }
+
+    // Второй буфер поколения целиком перезаписывается, так что отданный достаточно
+    // поменять на запасной
+    void reclaim(BasicGrid<Cell>& grid) {
+        if (held(grid)) {
+            std::swap(grid, spare_);
+        }
+    }
+
+    // Текущее поколение еще нужно решателю: отданный буфер уходит в запас, поле
+    // продолжает с его копии. Нужно только перед новым хранилищем, которое копирует поле и так
+    void detach(BasicGrid<Cell>& grid) {
+        if (held(grid)) {
+            spare_ = grid;
+            std::swap(grid, spare_);
+        }
+    }
+
+private:
+    bool held(const BasicGrid<Cell>& grid) const { return busy() && grid.data.data() == lent_; }
+
+    const Cell* lent_ = nullptr;
+    std::shared_ptr<std::atomic<bool>> released_;
+    BasicGrid<Cell> spare_;
+};
+
+// Снимок из отданного буфера поколения: границы и расположение запоминаются,
+// клетки читаются прямо из буфера
+template <typename Cell>
+class LentGrid : public FieldSnapshot {
+public:
+    LentGrid(const BasicGrid<Cell>& grid, GridLease<Cell>& lease)
+        : bounds_(grid), cells_(grid.data.data()), pitch_(grid.pitch), origin_(grid.origin), released_(lease.lend(grid)) {}
+    ~LentGrid() override { released_->store(true, std::memory_order_release); }
+
+    LentGrid(const LentGrid&) = delete;
+    LentGrid& operator=(const LentGrid&) = delete;
+
+    Bounds bounds() const override { return bounds_; }
+    void readRow(size_t y, uint64_t* out) const override {
+        const Cell* cells = row(y);
+        std::copy(cells, cells + bounds_.width(), out);
+    }
+
+protected:
+    const Cell* row(size_t y) const { return cells_ + origin_ + y * pitch_; }
+    size_t index(size_t x, size_t y) const { return origin_ + y * pitch_ + x; }
+
+private:
+    Bounds bounds_;
+    const Cell* cells_;
+    size_t pitch_;
+    size_t origin_;
+    std::shared_ptr<std::atomic<bool>> released_;
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "grid.h"
+#include "lease.h"
+#include "pool.h"
+#include "sandpile.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Синхронная модель на байтовых клетках. Почти все клетки держат 0-7 песчинок,
+// байта хватает, а поле занимает в 8 раз меньше памяти, чем Grid. Строка считается
+// векторно (AVX2, если доступен при сборке), соседи читаются сдвинутыми загрузками.
+// Клетки, где песчинок не меньше kEscape, вынесены в таблицу с точными значениями;
+// в байтовом поле у них стоит kEscapeMark. Такие клетки и их соседи после векторного
+// прохода пересчитываются заново по точным значениям.
+class NarrowSolver : public SandpileSolver {
+public:
+    static constexpr uint8_t kEscape = 240;
+    static constexpr uint8_t kEscapeMark = 0xFF;
+
+    // Байтовое поле строится со своим запасом spare, запас хранилища grid не переносится
+    explicit NarrowSolver(const Grid& grid, bool bulk = false, unsigned threads = 1, const Spare& spare = Spare());
+
+    bool step() override;
+
+    Bounds bounds() const override { return current_; }
+    void readRow(size_t y, uint64_t* out) const override;
+    std::unique_ptr<FieldSnapshot> snapshot() override;
+
+private:
+    void growIfNeeded();
+    // Точные значения клеток таблицы и их соседей в следующем поколении
+    void fixEscapes();
+    uint64_t sweepRows(size_t first, size_t last);
+    uint64_t value(size_t index) const;
+
+    BasicGrid<uint8_t> current_;
+    BasicGrid<uint8_t> next_;
+    std::unordered_map<size_t, uint64_t> escapes_;
+    std::unordered_map<size_t, uint64_t> next_escapes_;
+    std::vector<size_t> touched_;
+    bool bulk_;
+    std::unique_ptr<WorkerPool> pool_;
+    // После буферов: разрушается первым и дожидается снимка
+    GridLease<uint8_t> lease_;
+};
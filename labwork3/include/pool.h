@@ -0,0 +1,62 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Постоянный набор потоков: run() выполняет task(0) ... task(size() - 1) параллельно
+// и ждет завершения. Нулевую часть выполняет вызывающий поток. Потоки создаются
+// один раз, между вызовами спят на условной переменной.
+class WorkerPool {
+public:
+    // threads - общее число исполнителей вместе с вызывающим потоком; 0 - по числу ядер
+    explicit WorkerPool(unsigned threads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers_.size()) + 1; }
+
+    template <typename Task>
+    void run(const Task& task) {
+        dispatch(&task, [](const void* context, unsigned index) { (*static_cast<const Task*>(context))(index); });
+    }
+
+private:
+    // Задача передается без std::function, чтобы вызов run() ничего не выделял
+    using Invoke = void (*)(const void*, unsigned);
+
+    void dispatch(const void* task, Invoke invoke);
+    void work(unsigned index);
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    const void* task_ = nullptr;
+    Invoke invoke_ = nullptr;
+    uint64_t generation_ = 0;
+    unsigned pending_ = 0;
+    bool stop_ = false;
+};
+
+// Делит строки [0, rows) на полосы не тоньше min_rows, по одной на поток, и вызывает
+// sweep(first, last) для каждой; возвращает сумму результатов вызовов
+template <typename Sweep>
+uint64_t sweepStripes(WorkerPool& pool, size_t rows, size_t min_rows, const Sweep& sweep) {
+    const size_t stripes = std::min<size_t>(pool.size(), (rows + min_rows - 1) / min_rows);
+    if (stripes <= 1) {
+        return sweep(0, rows);
+    }
+    std::atomic<uint64_t> result(0);
+    pool.run([&](unsigned index) {
+        if (index < stripes) {
+            result.fetch_add(sweep(rows * index / stripes, rows * (index + 1) / stripes), std::memory_order_relaxed);
+        }
+    });
+    return result.load(std::memory_order_relaxed);
+}
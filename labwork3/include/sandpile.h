@@ -1,4 +1,73 @@
 #pragma once
+#include "config.h"
 #include "grid.h"
+#include "lease.h"
+#include "pool.h"
+#include <memory>
 
-Grid nextIteration(const Grid& grid, bool& hasToppled);
\ No newline at end of file
+// Общий интерфейс способов пересчета модели
+class SandpileSolver {
+public:
+    virtual ~SandpileSolver() = default;
+
+    // Одна итерация; возвращает false, если ни одна клетка не осыпалась
+    virtual bool step() = 0;
+
+    // Сколько обвалов было с начала расчета; в режиме bulk обвал клетки с value
+    // песчинками считается за value / 4
+    uint64_t topplings() const { return topplings_; }
+
+    virtual Bounds bounds() const = 0;
+
+    // Строка y поля (от 0): bounds().width() значений
+    virtual void readRow(size_t y, uint64_t* out) const = 0;
+
+    // Текущее поле для чтения из другого потока, пока решатель считает дальше.
+    // По умолчанию поле копируется; решатели с двумя буферами поколений отдают
+    // текущий буфер без копирования (см. GridLease). Решатель не разрушается,
+    // пока снимок жив, а ждет его
+    virtual std::unique_ptr<FieldSnapshot> snapshot();
+
+protected:
+    uint64_t topplings_ = 0;
+};
+
+// Синхронная модель: за итерацию каждая клетка с >= 4 песчинками отдает по одной
+// каждому соседу. Следующее поколение считается во второй буфер, затем буферы
+// меняются местами - в установившемся режиме итерация ничего не выделяет.
+// bulk: клетка осыпается сразу на value / 4 песчинок каждому соседу.
+// threads != 1: поле делится на горизонтальные полосы, по одной на поток
+class SyncSolver : public SandpileSolver {
+public:
+    // Полосы тоньше этого не выгодно отдавать отдельному потоку
+    static constexpr size_t kMinStripeRows = 16;
+
+    explicit SyncSolver(Grid grid, bool bulk = false, unsigned threads = 1);
+
+    bool step() override;
+
+    Bounds bounds() const override { return current_; }
+    void readRow(size_t y, uint64_t* out) const override { readGridRow(current_, y, out); }
+    std::unique_ptr<FieldSnapshot> snapshot() override;
+
+    const Grid& grid() const { return current_; }
+
+private:
+    // Расширяет поле на клетку в сторону каждой осыпающейся границы
+    void growIfNeeded();
+    // Следующее поколение строк [first, last); число обвалов в них
+    uint64_t sweepRows(size_t first, size_t last);
+
+    Grid current_;
+    Grid next_;
+    bool bulk_;
+    std::unique_ptr<WorkerPool> pool_;
+    // После буферов: разрушается первым и дожидается снимка
+    GridLease<uint64_t> lease_;
+};
+
+// Решатель выбранного в config режима над заданным полем
+std::unique_ptr<SandpileSolver> makeSolver(const Config& config, Grid grid);
+
+// То же для начального состояния из входного файла
+std::unique_ptr<SandpileSolver> makeSolver(const Config& config);
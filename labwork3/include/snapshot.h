@@ -0,0 +1,64 @@
+#pragma once
+#include "animation.h"
+#include "bmp_writer.h"
+#include "grid.h"
+#include "sandpile.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Сохранение картинок в фоне. submit() снимает с решателя компактный снимок -
+// по байту на клетку с номером цвета (количество песчинок, но не больше 4) - и
+// кладет его в ограниченную очередь; картинки кодируют и пишут фоновые потоки.
+// Если очередь заполнена, submit() ждет, пока кодировщики ее разберут.
+// Буферы снимков переиспользуются, так что в установившемся режиме ничего не выделяется.
+// С анимацией снимки дописываются кадрами в один файл вместо картинок.
+class SnapshotWriter {
+public:
+    // encoders == 0 - картинка пишется сразу в вызывающем потоке
+    explicit SnapshotWriter(unsigned encoders, BmpFormat format = BmpFormat::Palette4, size_t capacity = 0);
+    // Кадры анимации зависят от предыдущих, поэтому кодировщик не больше одного
+    SnapshotWriter(unsigned encoders, std::unique_ptr<AnimationWriter> animation);
+    // Дописывает все, что осталось в очереди
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    // path - картинка кадра; с анимацией кадр помечается номером iteration
+    void submit(const SandpileSolver& solver, const std::string& path, uint64_t iteration);
+
+    // Сколько всего времени ушло на кодирование и запись готовых картинок
+    double encodeSeconds() const { return encode_ns_.load(std::memory_order_relaxed) * 1e-9; }
+
+private:
+    struct Snapshot {
+        Bounds bounds;
+        std::vector<uint8_t> levels;
+        std::string path;
+        uint64_t iteration;
+    };
+
+    void start(unsigned encoders);
+    std::unique_ptr<Snapshot> acquire();
+    void encode(const Snapshot& snapshot);
+    void work();
+
+    std::vector<std::thread> encoders_;
+    std::deque<std::unique_ptr<Snapshot>> queue_;
+    std::vector<std::unique_ptr<Snapshot>> free_;
+    std::vector<uint64_t> row_;
+    BmpFormat format_;
+    std::unique_ptr<AnimationWriter> animation_;
+    size_t capacity_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    bool stop_ = false;
+    std::atomic<uint64_t> encode_ns_{ 0 };
+};
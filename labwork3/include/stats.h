@@ -0,0 +1,43 @@
+#pragma once
+#include "sandpile.h"
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Ход расчета для профилирования. Раз в freq итераций пишется строка: номер итерации,
+// число неустойчивых клеток, границы поля и, с прошлой строки, число обвалов, время
+// в step(), время в submit() картинок, время фонового кодирования картинок и число
+// выделений памяти (0, если счетчик выделений не передан). Файл с расширением .jsonl пишется в JSON Lines, иначе в CSV.
+// Неустойчивые клетки считаются отдельным проходом по полю, поэтому частая запись
+// заметно замедляет расчет; без --stats программа ничего этого не делает.
+class StatsRecorder {
+public:
+    using Clock = std::chrono::steady_clock;
+    // Сколько выделений памяти было с начала счета
+    using AllocationCounter = uint64_t (*)();
+
+    StatsRecorder(const std::string& path, uint64_t freq, AllocationCounter allocations = nullptr);
+
+    void addStepTime(Clock::time_point started) { step_ += Clock::now() - started; }
+    void addSubmitTime(Clock::time_point started) { submit_ += Clock::now() - started; }
+
+    // Вызывается после итерации iteration; строка пишется, если пора или last
+    void record(uint64_t iteration, const SandpileSolver& solver, double encode_seconds, bool last);
+
+private:
+    uint64_t allocationCount() const;
+
+    std::ofstream file_;
+    uint64_t freq_;
+    bool json_;
+    uint64_t recorded_ = UINT64_MAX;
+    uint64_t topplings_ = 0;
+    AllocationCounter allocation_count_;
+    uint64_t allocations_ = 0;
+    double encode_seconds_ = 0;
+    Clock::duration step_ = Clock::duration::zero();
+    Clock::duration submit_ = Clock::duration::zero();
+    std::vector<uint64_t> row_;
+};
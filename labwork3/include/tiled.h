@@ -0,0 +1,78 @@
+#pragma once
+#include "grid.h"
+#include "pool.h"
+#include "sandpile.h"
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Синхронная модель на разреженном поле из плиток kTile x kTile. Плитки создаются,
+// когда в них впервые попадают песчинки, и хранятся в хеш-таблице по координатам
+// плитки, поэтому память пропорциональна занятой площади, а не охватывающему
+// прямоугольнику. Пересчитываются только активные плитки - с неустойчивыми клетками
+// и их соседи, куда эти клетки осыпаются. Активные плитки считаются параллельно.
+// Картинки совпадают с SyncSolver: границы поля растут по тем же правилам.
+class TiledSolver : public SandpileSolver {
+public:
+    static constexpr int kTileBits = 6;
+    static constexpr int kTile = 1 << kTileBits;
+
+    TiledSolver(const Bounds& bounds, const std::vector<Seed>& seeds, bool bulk = false, unsigned threads = 1);
+    // Раскладывает по плиткам ненулевые клетки готового поля
+    explicit TiledSolver(const Grid& grid, bool bulk = false, unsigned threads = 1);
+
+    bool step() override;
+
+    Bounds bounds() const override { return bounds_; }
+    void readRow(size_t y, uint64_t* out) const override;
+
+    size_t tileCount() const { return tiles_.size(); }
+
+private:
+    // Стороны плитки, на которых есть неустойчивые клетки
+    enum : uint8_t {
+        kNorth = 1,
+        kSouth = 2,
+        kWest = 4,
+        kEast = 8,
+    };
+
+    struct Tile {
+        int tx, ty;
+        std::array<std::vector<uint64_t>, 2> cells; // текущее и следующее поколения
+        int current = 0;
+        uint8_t edges = 0;
+        bool unstable = false;
+        uint64_t stamp = 0; // номер итерации, на которой плитка попала в список
+        std::array<Tile*, 4> neighbours = {}; // север, юг, запад, восток
+
+        const uint64_t* now() const { return cells[current].data(); }
+        uint64_t* now() { return cells[current].data(); }
+    };
+
+    TiledSolver(const Bounds& bounds, bool bulk, unsigned threads);
+
+    // Кладет value песчинок в клетку (x, y) в координатах модели
+    void place(int x, int y, uint64_t value);
+    // Заносит в список активных плитки с неустойчивыми клетками
+    void activate();
+    Tile* find(int tx, int ty) const;
+    Tile& tile(int tx, int ty);
+    // Флаги неустойчивости плитки по ее клеткам cells
+    static void updateFlags(Tile& tile, const uint64_t* cells);
+    // Расширяет границы поля в сторону осыпающихся краев
+    void growBounds();
+    // Следующее поколение плитки; scratch - буфер (kTile + 2)^2 с рамкой из соседей
+    uint64_t sweepTile(Tile& tile, std::vector<uint64_t>& scratch) const;
+
+    std::unordered_map<uint64_t, std::unique_ptr<Tile>> tiles_;
+    std::vector<Tile*> active_;
+    std::vector<Tile*> work_;
+    std::vector<std::vector<uint64_t>> scratch_;
+    std::vector<uint64_t> toppled_; // обвалы каждого исполнителя за итерацию
+    Bounds bounds_;
+    uint64_t iteration_ = 0;
+    bool bulk_;
+    std::unique_ptr<WorkerPool> pool_;
+};
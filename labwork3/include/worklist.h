@@ -0,0 +1,44 @@
+#pragma once
+#include "grid.h"
+#include "sandpile.h"
+#include <vector>
+
+// Асинхронная модель: осыпаются только клетки из очереди неустойчивых. Итерация -
+// один проход по очереди, накопленной к ее началу; каждая клетка осыпается за проход
+// не больше одного раза, и ее соседи видят результат сразу. По абелевости
+// устойчивое состояние то же, что у синхронной модели, промежуточные - нет.
+// bulk: клетка за проход отдает все, что может, и остается с value % 4 песчинками
+class WorklistSolver : public SandpileSolver {
+public:
+    explicit WorklistSolver(Grid grid, bool bulk = false);
+
+    bool step() override;
+
+    Bounds bounds() const override { return grid_; }
+    void readRow(size_t y, uint64_t* out) const override { readGridRow(grid_, y, out); }
+
+    const Grid& grid() const { return grid_; }
+
+private:
+    // Флаги клеток: в очереди, рамка, крайняя клетка поля
+    enum : uint8_t {
+        kQueued = 1,
+        kHalo = 2,
+        kBorder = 4,
+    };
+
+    void push(size_t index);
+    // Флаги по текущим границам поля; клетки из очереди помечаются заново
+    void resetFlags();
+    // Ставит флаг flag (kBorder или 0) всем крайним клеткам поля, сохраняя kQueued
+    void markBorder(uint8_t flag);
+    // Переносит песчинки, упавшие в рамку, в новые клетки поля
+    void grow();
+
+    Grid grid_;
+    std::vector<uint8_t> flags_;
+    std::vector<size_t> queue_;
+    std::vector<size_t> current_;
+    bool bulk_;
+    bool spilled_ = false;
+};
@@ -0,0 +1,11 @@
+#pragma once
+#include <cstdint>
+
+// Счетчик выделений памяти для --stats. Замена глобальных operator new/delete лежит
+// в alloc_counter.cpp, который собирается только в sandpile_model: библиотека, замеры
+// и тесты работают со стандартным распределителем. Пока счет не включен, каждое
+// выделение стоит лишнюю загрузку одного флага
+void startAllocationCounting();
+
+// Сколько раз вызывались формы operator new с момента startAllocationCounting()
+uint64_t allocationCount();
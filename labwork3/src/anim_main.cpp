@@ -0,0 +1,82 @@
+// Декодер анимации sandpile_model --animation.
+//
+//   sandpile_anim FILE                          - список кадров
+//   sandpile_anim FILE -o OUT.bmp [--frame N]   - кадр итерации N (по умолчанию последний) в BMP
+//   [--bmp24]                                   - картинка в 24 бита на точку
+#include "animation.h"
+#include "bmp_writer.h"
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace {
+
+int usage() {
+    std::cerr << "Usage: sandpile_anim FILE [-o OUT.bmp] [--frame N] [--bmp24]" << std::endl;
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        return usage();
+    }
+    std::string output;
+    uint64_t iteration = 0;
+    bool last = true;
+    BmpFormat format = BmpFormat::Palette4;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+            output = argv[++i];
+        }
+        else if (arg == "--frame" && i + 1 < argc) {
+            const char* value = argv[++i];
+            const char* end = value + std::strlen(value);
+            const std::from_chars_result parsed = std::from_chars(value, end, iteration);
+            if (parsed.ec != std::errc() || parsed.ptr != end) {
+                std::cerr << "Bad frame number: " << value << std::endl;
+                return usage();
+            }
+            last = false;
+        }
+        else if (arg == "--bmp24") {
+            format = BmpFormat::Rgb24;
+        }
+        else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return usage();
+        }
+    }
+
+    AnimationReader reader(argv[1]);
+    const std::vector<AnimationReader::Entry>& entries = reader.entries();
+    if (output.empty()) {
+        for (const AnimationReader::Entry& entry : entries) {
+            std::cout << entry.iteration << '\t' << (entry.keyframe ? "key" : "delta") << '\t'
+                << entry.bounds.min_x << ' ' << entry.bounds.max_x << ' '
+                << entry.bounds.min_y << ' ' << entry.bounds.max_y << '\t' << entry.size << std::endl;
+        }
+        return 0;
+    }
+
+    size_t index = entries.size();
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (last || entries[i].iteration == iteration) {
+            index = i;
+        }
+    }
+    if (index == entries.size()) {
+        std::cerr << "No such frame" << std::endl;
+        return 1;
+    }
+    AnimationFrame frame = reader.frame(index);
+    const size_t width = frame.bounds.width();
+    LevelReader row = [&](size_t y, uint8_t* out) {
+        std::copy(&frame.levels[y * width], &frame.levels[(y + 1) * width], out);
+    };
+    saveBMP(frame.bounds, row, output, format);
+    return 0;
+}
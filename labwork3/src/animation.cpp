@@ -0,0 +1,264 @@
+#include "animation.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const char kAnimationMagic[8] = { 'S', 'A', 'N', 'D', 'A', 'N', 'I', '1' };
+const size_t kFrameHeaderSize = 1 + 8 + 4 * 4 + 8;
+// Больше клеток в кадре не бывает: по длине данных размер кадра не ограничить,
+// потому что одна серия покрывает сколько угодно клеток, а поле выделяется целиком
+const uint64_t kMaxFrameCells = uint64_t(1) << 32;
+
+enum : uint8_t {
+    kKeyframe = 0,
+    kDelta = 1,
+};
+
+void putLE(uint8_t* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint64_t getLE(const uint8_t* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= uint64_t(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+// Размеры по границам из файла, без переполнения int на любых значениях
+uint64_t frameWidth(const Bounds& bounds) {
+    return int64_t(bounds.max_x) - bounds.min_x + 1;
+}
+
+uint64_t frameHeight(const Bounds& bounds) {
+    return int64_t(bounds.max_y) - bounds.min_y + 1;
+}
+
+// Серии короче этого выгоднее писать в сплошной кусок, чем отдельной серией
+const size_t kMinRun = 4;
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool getVarint(const uint8_t*& in, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; in != end && shift < 64; shift += 7) {
+        const uint8_t byte = *in++;
+        value |= uint64_t(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Сплошной кусок: значения (все меньше 16) по два в байте, первое - в старшей половине
+void putLiteral(std::vector<uint8_t>& out, const uint8_t* data, size_t count) {
+    putVarint(out, (uint64_t(count) << 1) | 1);
+    for (size_t i = 0; i < count; i += 2) {
+        out.push_back(static_cast<uint8_t>((data[i] << 4) | (i + 1 < count ? data[i + 1] : 0)));
+    }
+}
+
+// Поток токенов: varint (длина << 1 | сплошной), затем для серии - байт значения,
+// для сплошного куска - упакованные значения. В разностных кадрах длинные серии
+// нулей, а места, где клетки меняются почти все, стоят по полбайта на клетку
+void rleEncode(const uint8_t* data, size_t count, std::vector<uint8_t>& out) {
+    size_t literal = 0; // начало еще не записанного сплошного куска
+    size_t i = 0;
+    while (i < count) {
+        size_t run = 1;
+        while (i + run < count && data[i + run] == data[i]) {
+            ++run;
+        }
+        if (run >= kMinRun) {
+            if (literal < i) {
+                putLiteral(out, data + literal, i - literal);
+            }
+            putVarint(out, uint64_t(run) << 1);
+            out.push_back(data[i]);
+            literal = i + run;
+        }
+        i += run;
+    }
+    if (literal < count) {
+        putLiteral(out, data + literal, count - literal);
+    }
+}
+
+// false, если данные повреждены или дают не count значений
+bool rleDecode(const uint8_t* in, size_t size, uint8_t* out, size_t count) {
+    const uint8_t* end = in + size;
+    size_t filled = 0;
+    while (in != end) {
+        uint64_t token;
+        if (!getVarint(in, end, token)) {
+            return false;
+        }
+        const uint64_t length = token >> 1;
+        if (length > count - filled) {
+            return false;
+        }
+        if ((token & 1) == 0) {
+            if (in == end) {
+                return false;
+            }
+            std::memset(out + filled, *in++, length);
+        }
+        else {
+            if (static_cast<uint64_t>(end - in) < (length + 1) / 2) {
+                return false;
+            }
+            for (uint64_t j = 0; j < length; ++j) {
+                out[filled + j] = (j & 1) == 0 ? in[j / 2] >> 4 : in[j / 2] & 0x0F;
+            }
+            in += (length + 1) / 2;
+        }
+        filled += length;
+    }
+    return filled == count;
+}
+
+// Кадр from, перенесенный в границы to; клетки вне прежних границ нулевые
+void placeFrame(const AnimationFrame& from, const Bounds& to, std::vector<uint8_t>& out) {
+    out.assign(to.width() * to.height(), 0);
+    const int first_x = std::max(from.bounds.min_x, to.min_x);
+    const int last_x = std::min(from.bounds.max_x, to.max_x);
+    const int first_y = std::max(from.bounds.min_y, to.min_y);
+    const int last_y = std::min(from.bounds.max_y, to.max_y);
+    if (first_x > last_x || first_y > last_y) {
+        return;
+    }
+    const size_t from_width = from.bounds.width();
+    const size_t to_width = to.width();
+    for (int y = first_y; y <= last_y; ++y) {
+        const uint8_t* src = &from.levels[(y - from.bounds.min_y) * from_width + (first_x - from.bounds.min_x)];
+        std::copy(src, src + (last_x - first_x + 1), &out[(y - to.min_y) * to_width + (first_x - to.min_x)]);
+    }
+}
+
+} // namespace
+
+AnimationWriter::AnimationWriter(const std::string& path)
+    : file_(path, std::ios::binary), path_(path) {
+    if (!file_) {
+        std::cerr << "Cannot open animation file " << path << std::endl;
+        exit(1);
+    }
+    file_.write(kAnimationMagic, sizeof(kAnimationMagic));
+}
+
+void AnimationWriter::append(uint64_t iteration, const Bounds& bounds, const std::vector<uint8_t>& levels) {
+    const bool keyframe = frames_ % kKeyframeInterval == 0;
+    const std::vector<uint8_t>* source = &levels;
+    if (!keyframe) {
+        placeFrame(previous_, bounds, delta_);
+        for (size_t i = 0; i < delta_.size(); ++i) {
+            delta_[i] ^= levels[i];
+        }
+        source = &delta_;
+    }
+    packed_.clear();
+    rleEncode(source->data(), source->size(), packed_);
+
+    uint8_t header[kFrameHeaderSize];
+    header[0] = keyframe ? kKeyframe : kDelta;
+    putLE(header + 1, iteration, 8);
+    putLE(header + 9, static_cast<uint32_t>(bounds.min_x), 4);
+    putLE(header + 13, static_cast<uint32_t>(bounds.max_x), 4);
+    putLE(header + 17, static_cast<uint32_t>(bounds.min_y), 4);
+    putLE(header + 21, static_cast<uint32_t>(bounds.max_y), 4);
+    putLE(header + 25, packed_.size(), 8);
+    file_.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file_.write(reinterpret_cast<const char*>(packed_.data()), packed_.size());
+    if (!file_) {
+        std::cerr << "Cannot write animation file " << path_ << std::endl;
+        exit(1);
+    }
+
+    previous_.iteration = iteration;
+    previous_.bounds = bounds;
+    previous_.levels.assign(levels.begin(), levels.end());
+    frames_++;
+}
+
+AnimationReader::AnimationReader(const std::string& path)
+    : file_(path, std::ios::binary), path_(path) {
+    char magic[sizeof(kAnimationMagic)];
+    if (!file_.read(magic, sizeof(magic)) || std::memcmp(magic, kAnimationMagic, sizeof(magic)) != 0) {
+        std::cerr << "Not an animation file: " << path << std::endl;
+        exit(1);
+    }
+    file_.seekg(0, std::ios::end);
+    const uint64_t file_size = static_cast<uint64_t>(file_.tellg());
+    uint64_t offset = sizeof(kAnimationMagic);
+    // Недописанный последний кадр (расчет прервали) пропускается
+    while (offset + kFrameHeaderSize <= file_size) {
+        uint8_t header[kFrameHeaderSize];
+        file_.seekg(static_cast<std::streamoff>(offset));
+        file_.read(reinterpret_cast<char*>(header), sizeof(header));
+        Entry entry;
+        entry.keyframe = header[0] == kKeyframe;
+        entry.iteration = getLE(header + 1, 8);
+        entry.bounds.min_x = static_cast<int32_t>(getLE(header + 9, 4));
+        entry.bounds.max_x = static_cast<int32_t>(getLE(header + 13, 4));
+        entry.bounds.min_y = static_cast<int32_t>(getLE(header + 17, 4));
+        entry.bounds.max_y = static_cast<int32_t>(getLE(header + 21, 4));
+        entry.size = getLE(header + 25, 8);
+        entry.offset = offset + kFrameHeaderSize;
+        if (!file_ || entry.size > file_size - entry.offset) {
+            break;
+        }
+        if ((header[0] != kKeyframe && header[0] != kDelta) || (entries_.empty() && !entry.keyframe)
+            || entry.bounds.min_x > entry.bounds.max_x || entry.bounds.min_y > entry.bounds.max_y
+            || frameWidth(entry.bounds) > kMaxFrameCells / frameHeight(entry.bounds)) {
+            std::cerr << "Corrupted animation file: " << path << std::endl;
+            exit(1);
+        }
+        entries_.push_back(entry);
+        offset = entry.offset + entry.size;
+    }
+    file_.clear();
+}
+
+AnimationFrame AnimationReader::frame(size_t index) {
+    size_t first = index;
+    while (!entries_[first].keyframe) {
+        --first;
+    }
+    AnimationFrame current;
+    std::vector<uint8_t> packed;
+    std::vector<uint8_t> levels;
+    for (size_t i = first; i <= index; ++i) {
+        const Entry& entry = entries_[i];
+        packed.resize(entry.size);
+        file_.seekg(static_cast<std::streamoff>(entry.offset));
+        file_.read(reinterpret_cast<char*>(packed.data()), static_cast<std::streamsize>(packed.size()));
+        const size_t cells = entry.bounds.width() * entry.bounds.height();
+        std::vector<uint8_t> decoded(cells);
+        if (!file_ || !rleDecode(packed.data(), packed.size(), decoded.data(), cells)) {
+            std::cerr << "Corrupted animation file: " << path_ << std::endl;
+            exit(1);
+        }
+        if (!entry.keyframe) {
+            placeFrame(current, entry.bounds, levels);
+            for (size_t j = 0; j < cells; ++j) {
+                decoded[j] ^= levels[j];
+            }
+        }
+        current.iteration = entry.iteration;
+        current.bounds = entry.bounds;
+        current.levels.swap(decoded);
+    }
+    return current;
+}
@@ -1,56 +1,78 @@
 #include "bmp_writer.h"
 #include "grid.h"
+#include <algorithm>
 #include <fstream>
 #include <vector>
 
-void saveBMP(const Grid& grid, const std::string& path, int iteration) {
-    int width = grid.max_x - grid.min_x + 1;
-    int height = grid.max_y - grid.min_y + 1;
-    int row_padding = (4 - (width * 3) % 4) % 4;
-    int file_size = 54 + (width * 3 + row_padding) * height;
+namespace {
 
-    std::vector<uint8_t> img_data(file_size - 54, 0);
+// Цвета уровней 0-4 в порядке BMP: синий, зеленый, красный
+const uint8_t kPalette[5][3] = {
+    { 255, 255, 255 }, // 0 - белый
+    { 0, 128, 0 },     // 1 - зеленый
+    { 128, 0, 128 },   // 2 - фиолетовый
+    { 0, 255, 255 },   // 3 - желтый
+    { 0, 0, 0 },       // > 3 - черный
+};
 
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            uint64_t value = grid.data[y][x];
-            uint8_t r, g, b;
-            if (value == 0) {
-                r = g = b = 255;
-            }
-            else if (value == 1) {
-                r = 0; g = 128; b = 0;
-            }
-            else if (value == 2) {
-                r = 128; g = 0; b = 128;
-            }
-            else if (value == 3) {
-                r = 255; g = 255; b = 0;
-            }
-            else {
-                r = g = b = 0;
-            }
-            int pos = (y * (width * 3 + row_padding)) + x * 3;
-            img_data[pos] = b;
-            img_data[pos + 1] = g;
-            img_data[pos + 2] = r;
-        }
-    }
+void putU32(uint8_t* dst, uint32_t value) {
+    dst[0] = static_cast<uint8_t>(value);
+    dst[1] = static_cast<uint8_t>(value >> 8);
+    dst[2] = static_cast<uint8_t>(value >> 16);
+    dst[3] = static_cast<uint8_t>(value >> 24);
+}
+
+} // namespace
+
+void saveBMP(const Bounds& bounds, const LevelReader& row, const std::string& path, BmpFormat format) {
+    const uint32_t width = static_cast<uint32_t>(bounds.width());
+    const uint32_t height = static_cast<uint32_t>(bounds.height());
+    const bool palette = format == BmpFormat::Palette4;
+    const uint32_t bits = palette ? 4 : 24;
+    const uint32_t colors = palette ? 5 : 0;
+    // Строка BMP выравнивается до 4 байт
+    const uint32_t row_size = (width * bits + 31) / 32 * 4;
+    const uint32_t offset = 54 + 4 * colors;
+    const uint32_t file_size = offset + row_size * height;
 
-    std::ofstream file(path, std::ios::binary);
     uint8_t header[54] = {
         'B','M',
-        static_cast<uint8_t>(file_size), static_cast<uint8_t>(file_size >> 8),
-        static_cast<uint8_t>(file_size >> 16), static_cast<uint8_t>(file_size >> 24),
-        0,0,0,0, 54,0,0,0,
+        0,0,0,0, 0,0,0,0, 0,0,0,0,
         40,0,0,0,
-        static_cast<uint8_t>(width), static_cast<uint8_t>(width >> 8),
-        static_cast<uint8_t>(width >> 16), static_cast<uint8_t>(width >> 24),
-        static_cast<uint8_t>(height), static_cast<uint8_t>(height >> 8),
-        static_cast<uint8_t>(height >> 16), static_cast<uint8_t>(height >> 24),
-        1,0, 24,0,
+        0,0,0,0, 0,0,0,0,
+        1,0, static_cast<uint8_t>(bits),0,
         0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0
     };
-    file.write(reinterpret_cast<char*>(header), 54);
-    file.write(reinterpret_cast<char*>(img_data.data()), img_data.size());
-}
\ No newline at end of file
+    putU32(header + 2, file_size);
+    putU32(header + 10, offset);
+    putU32(header + 18, width);
+    putU32(header + 22, height);
+    putU32(header + 46, colors);
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    for (uint32_t i = 0; i < colors; ++i) {
+        const uint8_t entry[4] = { kPalette[i][0], kPalette[i][1], kPalette[i][2], 0 };
+        file.write(reinterpret_cast<const char*>(entry), sizeof(entry));
+    }
+
+    // Строки пишутся по одной из небольшого буфера, кадр целиком в памяти не собирается
+    std::vector<uint8_t> levels(width + 1);
+    std::vector<uint8_t> pixels(row_size);
+    for (uint32_t y = 0; y < height; ++y) {
+        row(y, levels.data());
+        if (palette) {
+            // Две точки на байт, левая - в старшей половине
+            levels[width] = 0;
+            for (uint32_t x = 0; x < width; x += 2) {
+                pixels[x / 2] = static_cast<uint8_t>((levels[x] << 4) | levels[x + 1]);
+            }
+        }
+        else {
+            for (uint32_t x = 0; x < width; ++x) {
+                std::copy(kPalette[levels[x]], kPalette[levels[x]] + 3, &pixels[3 * x]);
+            }
+        }
+        file.write(reinterpret_cast<const char*>(pixels.data()), row_size);
+    }
+}
@@ -0,0 +1,242 @@
+#include "checkpoint.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char kCheckpointMagic[8] = { 'S', 'A', 'N', 'D', 'P', 'C', 'K', '1' };
+const uint32_t kCheckpointVersion = 1;
+
+// Клетки хранятся в little-endian; на x86 и ARM это просто память
+void packCells(const uint64_t* values, size_t count, uint32_t cell_bytes, uint8_t* out) {
+    for (size_t i = 0; i < count; ++i) {
+        for (uint32_t b = 0; b < cell_bytes; ++b) {
+            out[i * cell_bytes + b] = static_cast<uint8_t>(values[i] >> (8 * b));
+        }
+    }
+}
+
+uint64_t unpackCell(const uint8_t* cell, uint32_t cell_bytes) {
+    uint64_t value = 0;
+    for (uint32_t b = 0; b < cell_bytes; ++b) {
+        value |= uint64_t(cell[b]) << (8 * b);
+    }
+    return value;
+}
+
+bool writeAll(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, bytes, size);
+        if (written < 0) {
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// read(y, scratch) возвращает строку y поля bounds: свою или записанную в scratch
+template <typename RowReader>
+bool writeCheckpoint(const Bounds& bounds, uint64_t iteration, const std::string& path, RowReader read) {
+    const size_t width = bounds.width();
+    const size_t height = bounds.height();
+    std::vector<uint64_t> row(width);
+
+    // Первый проход - ширина клетки по самому большому значению
+    uint64_t max_value = 0;
+    for (size_t y = 0; y < height; ++y) {
+        const uint64_t* cells = read(y, row.data());
+        max_value = std::max(max_value, *std::max_element(cells, cells + width));
+    }
+    uint32_t cell_bytes = 1;
+    while (cell_bytes < 8 && (max_value >> (8 * cell_bytes)) != 0) {
+        cell_bytes *= 2;
+    }
+
+    CheckpointHeader header = {};
+    std::memcpy(header.magic, kCheckpointMagic, sizeof(header.magic));
+    header.version = kCheckpointVersion;
+    header.cell_bytes = cell_bytes;
+    header.min_x = bounds.min_x;
+    header.max_x = bounds.max_x;
+    header.min_y = bounds.min_y;
+    header.max_y = bounds.max_y;
+    header.iteration = iteration;
+
+    const std::string temp = path + ".tmp";
+    int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = writeAll(fd, &header, sizeof(header));
+    std::vector<uint8_t> packed(width * cell_bytes);
+    for (size_t y = 0; ok && y < height; ++y) {
+        packCells(read(y, row.data()), width, cell_bytes, packed.data());
+        ok = writeAll(fd, packed.data(), packed.size());
+    }
+    // Переименовывать можно только то, что уже дошло до диска
+    ok = ok && ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    ok = ok && std::rename(temp.c_str(), path.c_str()) == 0;
+    if (!ok) {
+        std::remove(temp.c_str());
+    }
+    return ok;
+}
+
+[[noreturn]] void fail(const std::string& path, const char* message) {
+    std::cerr << "Cannot load checkpoint " << path << ": " << message << std::endl;
+    exit(1);
+}
+
+} // namespace
+
+bool saveCheckpoint(const SandpileSolver& solver, uint64_t iteration, const std::string& path) {
+    return writeCheckpoint(solver.bounds(), iteration, path, [&](size_t y, uint64_t* row) {
+        solver.readRow(y, row);
+        return static_cast<const uint64_t*>(row);
+    });
+}
+
+Checkpoint loadCheckpoint(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        fail(path, "cannot open file");
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(CheckpointHeader)) {
+        ::close(fd);
+        fail(path, "file is too short");
+    }
+    const size_t size = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        fail(path, "mmap failed");
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(mapping);
+
+    CheckpointHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    const uint32_t cell_bytes = header.cell_bytes;
+    if (std::memcmp(header.magic, kCheckpointMagic, sizeof(header.magic)) != 0 || header.version != kCheckpointVersion) {
+        fail(path, "not a checkpoint");
+    }
+    if ((cell_bytes != 1 && cell_bytes != 2 && cell_bytes != 4 && cell_bytes != 8)
+        || header.min_x > header.max_x || header.min_y > header.max_y) {
+        fail(path, "corrupted header");
+    }
+
+    // Размер сверяется до выделения поля: в испорченном заголовке границы могут быть любыми.
+    // height * cell_bytes не больше 2^35, так что сравнение через деление не переполняется
+    const uint64_t header_width = int64_t(header.max_x) - header.min_x + 1;
+    const uint64_t header_height = int64_t(header.max_y) - header.min_y + 1;
+    const uint64_t payload = size - sizeof(header);
+    if (header_width > payload / (header_height * cell_bytes)
+        || header_width * header_height * cell_bytes != payload) {
+        fail(path, "unexpected file size");
+    }
+
+    Checkpoint checkpoint;
+    checkpoint.iteration = header.iteration;
+    checkpoint.grid = makeGrid(header.min_x, header.max_x, header.min_y, header.max_y);
+    Grid& grid = checkpoint.grid;
+    const size_t width = grid.width();
+    const uint8_t* cells = bytes + sizeof(header);
+    for (size_t y = 0; y < grid.height(); ++y) {
+        uint64_t* row = &grid.data[grid.index(0, y)];
+        if (cell_bytes == sizeof(uint64_t)) {
+            std::memcpy(row, cells, width * sizeof(uint64_t));
+        }
+        else {
+            for (size_t x = 0; x < width; ++x) {
+                row[x] = unpackCell(cells + x * cell_bytes, cell_bytes);
+            }
+        }
+        cells += width * cell_bytes;
+    }
+    ::munmap(mapping, size);
+    return checkpoint;
+}
+
+CheckpointWriter::CheckpointWriter(std::string path)
+    : path_(std::move(path)) {
+    thread_ = std::thread(&CheckpointWriter::work, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    changed_.notify_all();
+    thread_.join();
+}
+
+bool CheckpointWriter::submit(SandpileSolver& solver, uint64_t iteration) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_) {
+            return false;
+        }
+    }
+    // Поток ждет pending_, так что слот сейчас свободен
+    field_ = solver.snapshot();
+    iteration_ = iteration;
+    last_ = iteration;
+    written_ = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ = true;
+    }
+    changed_.notify_all();
+    return true;
+}
+
+void CheckpointWriter::finish(const SandpileSolver& solver, uint64_t iteration) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this] { return !pending_; });
+    }
+    if (written_ && last_ == iteration) {
+        return;
+    }
+    last_ = iteration;
+    written_ = true;
+    if (!saveCheckpoint(solver, iteration, path_)) {
+        std::cerr << "Cannot write checkpoint " << path_ << std::endl;
+    }
+}
+
+void CheckpointWriter::work() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        changed_.wait(lock, [this] { return stop_ || pending_; });
+        if (!pending_) {
+            return;
+        }
+        lock.unlock();
+        const bool ok = writeCheckpoint(field_->bounds(), iteration_, path_, [&](size_t y, uint64_t* row) {
+            field_->readRow(y, row);
+            return static_cast<const uint64_t*>(row);
+        });
+        if (!ok) {
+            std::cerr << "Cannot write checkpoint " << path_ << std::endl;
+        }
+        // Буфер возвращается решателю до того, как слот освободится
+        field_.reset();
+        lock.lock();
+        pending_ = false;
+        changed_.notify_all();
+    }
+}
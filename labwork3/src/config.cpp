@@ -1,8 +1,9 @@
 #include "config.h"
+#include <iostream>
 #include <string>
 
 Config parseArgs(int argc, char** argv) {
-    Config config = { 0, 0, "", "", 0, 0 };
+    Config config = { 0, 0, "", "", 0, 0, SolverMode::Sync, false, 1, 1, false, "", 0, "", "", 1, "" };
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "-l" || arg == "--length") {
@@ -23,6 +24,55 @@ Config parseArgs(int argc, char** argv) {
         else if (arg == "-f" || arg == "--freq") {
             config.freq = std::stoull(argv[++i]);
         }
+        else if (arg == "-t" || arg == "--threads") {
+            config.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--encoders") {
+            config.encoders = static_cast<unsigned>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--bmp24") {
+            config.bmp24 = true;
+        }
+        else if (arg == "--checkpoint") {
+            config.checkpoint_file = argv[++i];
+        }
+        else if (arg == "--checkpoint-freq") {
+            config.checkpoint_freq = std::stoull(argv[++i]);
+        }
+        else if (arg == "--resume") {
+            config.resume_file = argv[++i];
+        }
+        else if (arg == "--stats") {
+            config.stats_file = argv[++i];
+        }
+        else if (arg == "--stats-freq") {
+            config.stats_freq = std::stoull(argv[++i]);
+        }
+        else if (arg == "--animation") {
+            config.animation_file = argv[++i];
+        }
+        else if (arg == "--bulk") {
+            config.bulk = true;
+        }
+        else if (arg == "--mode") {
+            std::string mode = argv[++i];
+            if (mode == "sync") {
+                config.mode = SolverMode::Sync;
+            }
+            else if (mode == "worklist") {
+                config.mode = SolverMode::Worklist;
+            }
+            else if (mode == "narrow") {
+                config.mode = SolverMode::Narrow;
+            }
+            else if (mode == "tiled") {
+                config.mode = SolverMode::Tiled;
+            }
+            else {
+                std::cerr << "Unknown mode: " << mode << std::endl;
+                exit(1);
+            }
+        }
     }
     return config;
 }
\ No newline at end of file
@@ -1,32 +1,241 @@
 #include "grid.h"
 #include "config.h"
+#include "pool.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
 #include <iostream>
-#include <fstream>
-#include <sstream>
-
-Grid loadInitialGrid(const Config& config) {
-    Grid grid;
-    grid.min_x = 0;
-    grid.max_x = config.width - 1;
-    grid.min_y = 0;
-    grid.max_y = config.length - 1;
-    grid.data.resize(config.length, std::vector<uint64_t>(config.width, 0));
-
-    std::ifstream file(config.input_file);
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        uint16_t x, y;
-        uint64_t value;
-        if (!(iss >> x >> y >> value)) {
+#include <memory>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Кусок файла меньше этого не стоит отдавать отдельному потоку
+const size_t kMinChunkBytes = 1 << 20;
+
+enum class ParseError {
+    None,
+    Format,
+    Bounds,
+};
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Число после пробелов; nullptr, если числа нет или оно не влезает в Value
+template <typename Value>
+const char* parseField(const char* p, const char* end, Value& value) {
+    while (p != end && isBlank(*p)) {
+        ++p;
+    }
+    std::from_chars_result result = std::from_chars(p, end, value);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+// Клетки строк [begin, end); begin - начало строки. Остаток строки после
+// третьего числа игнорируется, как при чтении через operator>>
+ParseError parseChunk(const char* begin, const char* end, const Config& config, std::vector<Seed>& seeds) {
+    const char* p = begin;
+    while (p != end) {
+        const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (line_end == nullptr) {
+            line_end = end;
+        }
+        Seed seed;
+        const char* q = parseField(p, line_end, seed.x);
+        q = q != nullptr ? parseField(q, line_end, seed.y) : nullptr;
+        q = q != nullptr ? parseField(q, line_end, seed.value) : nullptr;
+        if (q == nullptr) {
+            return ParseError::Format;
+        }
+        if (seed.x >= config.width || seed.y >= config.length) {
+            return ParseError::Bounds;
+        }
+        seeds.push_back(seed);
+        p = line_end == end ? end : line_end + 1;
+    }
+    return ParseError::None;
+}
+
+} // namespace
+
+Bounds initialBounds(const Config& config) {
+    return { 0, config.width - 1, 0, config.length - 1 };
+}
+
+std::vector<Seed> loadSeeds(const Config& config) {
+    std::vector<Seed> seeds;
+    int fd = ::open(config.input_file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Cannot open input file" << std::endl;
+        exit(1);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return seeds;
+    }
+    const size_t size = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Cannot open input file" << std::endl;
+        exit(1);
+    }
+    ::madvise(mapping, size, MADV_SEQUENTIAL);
+    const char* text = static_cast<const char*>(mapping);
+
+    // Файл режется на куски по границам строк, каждый кусок разбирается своим потоком
+    std::unique_ptr<WorkerPool> pool;
+    size_t chunks = 1;
+    if (config.threads != 1 && size >= 2 * kMinChunkBytes) {
+        pool = std::make_unique<WorkerPool>(config.threads);
+        chunks = std::min<size_t>(pool->size(), size / kMinChunkBytes);
+    }
+    std::vector<const char*> starts(chunks + 1, text + size);
+    starts[0] = text;
+    for (size_t i = 1; i < chunks; ++i) {
+        const char* cut = text + size * i / chunks;
+        const char* line_end = static_cast<const char*>(std::memchr(cut, '\n', text + size - cut));
+        starts[i] = std::max(starts[i - 1], line_end != nullptr ? line_end + 1 : text + size);
+    }
+    std::vector<std::vector<Seed>> parts(chunks);
+    std::vector<ParseError> errors(chunks, ParseError::None);
+    auto parse = [&](unsigned index) {
+        if (index < chunks) {
+            errors[index] = parseChunk(starts[index], starts[index + 1], config, parts[index]);
+        }
+    };
+    if (pool != nullptr) {
+        pool->run(parse);
+    }
+    else {
+        parse(0);
+    }
+    ::munmap(mapping, size);
+
+    // Ошибка сообщается по первому по порядку файла куску, как при чтении подряд
+    for (ParseError error : errors) {
+        if (error == ParseError::Format) {
             std::cerr << "Invalid input format" << std::endl;
             exit(1);
         }
-        if (x >= config.width || y >= config.length) {
+        if (error == ParseError::Bounds) {
             std::cerr << "Initial coordinates out of bounds" << std::endl;
             exit(1);
         }
-        grid.data[y][x] = value;
+    }
+    if (chunks == 1) {
+        return std::move(parts[0]);
+    }
+    size_t total = 0;
+    for (const std::vector<Seed>& part : parts) {
+        total += part.size();
+    }
+    seeds.reserve(total);
+    for (const std::vector<Seed>& part : parts) {
+        seeds.insert(seeds.end(), part.begin(), part.end());
+    }
+    return seeds;
+}
+
+namespace {
+
+// Запас вокруг bounds под устойчивое состояние total песчинок с центром масс (center_x, center_y)
+Spare spareAround(const Bounds& bounds, double total, double center_x, double center_y, size_t cell_bytes) {
+    // Куча из N песчинок осыпается в круг площадью около N / kStableDensity клеток.
+    // Круг такой площади строится вокруг центра масс; с каждой стороны поля запас -
+    // насколько круг за нее выходит, с небольшим допуском. Если оценка промахнется,
+    // поле все равно вырастет через growGrid, только с лишними копированиями
+    const double kStableDensity = 2.125;
+    const double kMargin = 1.1;
+    // Запас не раздувает хранилище больше этого; в клетках - по ширине клетки решателя
+    const double kMaxBytes = double(uint64_t(1) << 31);
+    const double max_cells = kMaxBytes / cell_bytes;
+    Spare spare;
+    if (total < 4) {
+        return spare;
+    }
+    double radius = std::sqrt(total / (kStableDensity * M_PI)) * kMargin + 2;
+    const double width = static_cast<double>(bounds.width());
+    const double height = static_cast<double>(bounds.height());
+    // Для огромных куч хранилище ограничено: дальше поле дорастет само
+    if ((width + 2 * radius) * (height + 2 * radius) > max_cells) {
+        // Корень уравнения (width + 2r)(height + 2r) = max_cells
+        const double b = width + height;
+        const double discriminant = b * b - 4 * (width * height - max_cells);
+        radius = std::max(0.0, (std::sqrt(std::max(0.0, discriminant)) - b) / 4);
+    }
+    auto beyond = [&](double distance) { return static_cast<size_t>(std::max(0.0, std::ceil(radius - distance))); };
+    spare.left = beyond(center_x - bounds.min_x);
+    spare.right = beyond(bounds.max_x - center_x);
+    spare.top = beyond(center_y - bounds.min_y);
+    spare.bottom = beyond(bounds.max_y - center_y);
+    return spare;
+}
+
+} // namespace
+
+Spare predictSpare(const Bounds& bounds, const std::vector<Seed>& seeds, size_t cell_bytes) {
+    double total = 0, sum_x = 0, sum_y = 0;
+    for (const Seed& seed : seeds) {
+        const double grains = static_cast<double>(seed.value);
+        total += grains;
+        sum_x += grains * seed.x;
+        sum_y += grains * seed.y;
+    }
+    if (total == 0) {
+        return Spare();
+    }
+    return spareAround(bounds, total, bounds.min_x + sum_x / total, bounds.min_y + sum_y / total, cell_bytes);
+}
+
+Spare predictSpare(const Grid& grid, size_t cell_bytes) {
+    double total = 0, sum_x = 0, sum_y = 0;
+    for (size_t y = 0; y < grid.height(); ++y) {
+        const uint64_t* row = &grid.data[grid.index(0, y)];
+        for (size_t x = 0; x < grid.width(); ++x) {
+            const double grains = static_cast<double>(row[x]);
+            total += grains;
+            sum_x += grains * x;
+            sum_y += grains * y;
+        }
+    }
+    if (total == 0) {
+        return Spare();
+    }
+    return spareAround(grid, total, grid.min_x + sum_x / total, grid.min_y + sum_y / total, cell_bytes);
+}
+
+Grid makeInitialGrid(const Bounds& bounds, const std::vector<Seed>& seeds, const Spare& spare) {
+    Grid grid = makeGrid(bounds.min_x, bounds.max_x, bounds.min_y, bounds.max_y, spare);
+    for (const Seed& seed : seeds) {
+        grid.at(seed.x, seed.y) = seed.value;
     }
     return grid;
-}
\ No newline at end of file
+}
+
+Grid reserveSpare(Grid grid, const Spare& spare) {
+    const size_t left = grid.origin % grid.pitch - 1;
+    const size_t top = grid.origin / grid.pitch - 1;
+    const size_t right = grid.pitch - left - grid.width() - 2;
+    const size_t bottom = grid.data.size() / grid.pitch - top - grid.height() - 2;
+    if (left >= spare.left && right >= spare.right && top >= spare.top && bottom >= spare.bottom) {
+        return grid;
+    }
+    Spare wanted = spare;
+    wanted.left = std::max(wanted.left, left);
+    wanted.right = std::max(wanted.right, right);
+    wanted.top = std::max(wanted.top, top);
+    wanted.bottom = std::max(wanted.bottom, bottom);
+    Grid reserved = makeGrid(grid.min_x, grid.max_x, grid.min_y, grid.max_y, wanted);
+    for (size_t y = 0; y < grid.height(); ++y) {
+        const uint64_t* row = &grid.data[grid.index(0, y)];
+        std::copy(row, row + grid.width(), &reserved.data[reserved.index(0, y)]);
+    }
+    return reserved;
+}
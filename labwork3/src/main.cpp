@@ -1,7 +1,11 @@
+#include "alloc_counter.h"
+#include "animation.h"
+#include "checkpoint.h"
 #include "config.h"
 #include "grid.h"
 #include "sandpile.h"
-#include "bmp_writer.h"
+#include "snapshot.h"
+#include "stats.h"
 #include <filesystem>
 #include <iostream>
 
@@ -9,28 +13,69 @@ namespace fs = std::filesystem;
 
 int main(int argc, char** argv) {
     Config config = parseArgs(argc, argv);
-    fs::create_directories(config.output_dir);
+    if (!config.output_dir.empty()) {
+        fs::create_directories(config.output_dir);
+    }
 
-    Grid grid = loadInitialGrid(config);
-    bool stable = false;
+    std::unique_ptr<SandpileSolver> solver;
     uint64_t iter = 0;
+    if (!config.resume_file.empty()) {
+        // Продолжение с контрольной точки: поле и номер итерации берутся из нее
+        Checkpoint checkpoint = loadCheckpoint(config.resume_file);
+        iter = checkpoint.iteration;
+        solver = makeSolver(config, std::move(checkpoint.grid));
+    }
+    else {
+        solver = makeSolver(config);
+    }
+    std::unique_ptr<SnapshotWriter> writer;
+    if (!config.animation_file.empty()) {
+        writer = std::make_unique<SnapshotWriter>(config.encoders, std::make_unique<AnimationWriter>(config.animation_file));
+    }
+    else {
+        writer = std::make_unique<SnapshotWriter>(config.encoders, config.bmp24 ? BmpFormat::Rgb24 : BmpFormat::Palette4);
+    }
+    std::unique_ptr<CheckpointWriter> checkpoints;
+    if (!config.checkpoint_file.empty()) {
+        checkpoints = std::make_unique<CheckpointWriter>(config.checkpoint_file);
+    }
+    std::unique_ptr<StatsRecorder> stats;
+    if (!config.stats_file.empty()) {
+        startAllocationCounting();
+        stats = std::make_unique<StatsRecorder>(config.stats_file, config.stats_freq, allocationCount);
+    }
+    bool stable = false;
 
     while (iter < config.max_iter && !stable) {
-        bool hasToppled = false;
-        Grid new_grid = nextIteration(grid, hasToppled);
+        StatsRecorder::Clock::time_point started;
+        if (stats != nullptr) started = StatsRecorder::Clock::now();
+        bool hasToppled = solver->step();
         if (!hasToppled) stable = true;
+        if (stats != nullptr) stats->addStepTime(started);
 
         if (config.freq > 0 && (iter % config.freq == 0 || iter == config.max_iter - 1 || stable)) {
+            if (stats != nullptr) started = StatsRecorder::Clock::now();
             std::string path = config.output_dir + "/iter_" + std::to_string(iter) + ".bmp";
-            saveBMP(new_grid, path, iter);
+            writer->submit(*solver, path, iter);
+            if (stats != nullptr) stats->addSubmitTime(started);
         }
 
-        grid = new_grid;
+        if (stats != nullptr) {
+            stats->record(iter, *solver, writer->encodeSeconds(), stable || iter == config.max_iter - 1);
+        }
         iter++;
+        if (checkpoints != nullptr && config.checkpoint_freq > 0 && iter % config.checkpoint_freq == 0) {
+            checkpoints->submit(*solver, iter);
+        }
     }
 
     if (config.freq == 0 && !stable) {
-        saveBMP(grid, config.output_dir + "/final.bmp", iter);
+        writer->submit(*solver, config.output_dir + "/final.bmp", iter > 0 ? iter - 1 : 0);
+    }
+
+    if (checkpoints != nullptr) {
+        // Последняя точка пишется всегда: с нее можно продолжить с большим -m
+        checkpoints->finish(*solver, iter);
     }
 
     return 0;
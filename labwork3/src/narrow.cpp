@@ -0,0 +1,229 @@
+#include "narrow.h"
+#include "grid.h"
+#include <algorithm>
+#include <utility>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Следующее поколение байтовой строки, те же правила, что и у SyncSolver.
+// Клетки с kEscapeMark и их соседи получают здесь неверные значения, их исправляет fixEscapes().
+// Возвращает число обвалов, как sweepRow
+template <bool Bulk>
+uint64_t sweepNarrowRow(const uint8_t* src, uint8_t* dst, size_t width, size_t stride) {
+    size_t x = 0;
+    uint64_t topplings = 0;
+#ifdef __AVX2__
+    const __m256i three = _mm256_set1_epi8(3);
+    const __m256i four = _mm256_set1_epi8(4);
+    const __m256i low6 = _mm256_set1_epi8(0x3F);
+    // В AVX2 нет побайтового сдвига: сдвигаем 16-битные слова и отрезаем чужие биты
+    auto quarter = [&](__m256i v) { return _mm256_and_si256(_mm256_srli_epi16(v, 2), low6); };
+    // 0xFF там, где песчинок не меньше 4; вычитание маски прибавляет единицу
+    auto unstable_mask = [&](__m256i v) { return _mm256_cmpeq_epi8(_mm256_max_epu8(v, four), v); };
+    // Обвалы bulk копятся в четырех 64-битных суммах
+    __m256i shares = _mm256_setzero_si256();
+    for (; x + 32 <= width; x += 32) {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x));
+        __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x - 1));
+        __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x + 1));
+        __m256i up = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x - stride));
+        __m256i down = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x + stride));
+        __m256i result;
+        if constexpr (Bulk) {
+            __m256i self = quarter(value);
+            shares = _mm256_add_epi64(shares, _mm256_sad_epu8(self, _mm256_setzero_si256()));
+            result = _mm256_add_epi8(_mm256_and_si256(value, three),
+                _mm256_add_epi8(_mm256_add_epi8(quarter(left), quarter(right)),
+                    _mm256_add_epi8(quarter(up), quarter(down))));
+        }
+        else {
+            __m256i self = unstable_mask(value);
+            topplings += static_cast<unsigned>(__builtin_popcount(static_cast<unsigned>(_mm256_movemask_epi8(self))));
+            result = _mm256_sub_epi8(value, _mm256_and_si256(self, four));
+            result = _mm256_sub_epi8(result, _mm256_add_epi8(unstable_mask(left), unstable_mask(right)));
+            result = _mm256_sub_epi8(result, _mm256_add_epi8(unstable_mask(up), unstable_mask(down)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), result);
+    }
+    alignas(32) uint64_t sums[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(sums), shares);
+    topplings += sums[0] + sums[1] + sums[2] + sums[3];
+#endif
+    for (; x < width; ++x) {
+        unsigned value = src[x];
+        if constexpr (Bulk) {
+            topplings += value >> 2;
+            dst[x] = static_cast<uint8_t>((value & 3)
+                + (src[x - 1] >> 2) + (src[x + 1] >> 2)
+                + (src[x - stride] >> 2) + (src[x + stride] >> 2));
+        }
+        else {
+            unsigned self = value >= 4;
+            topplings += self;
+            dst[x] = static_cast<uint8_t>(value - 4 * self
+                + (src[x - 1] >= 4) + (src[x + 1] >= 4)
+                + (src[x - stride] >= 4) + (src[x + stride] >= 4));
+        }
+    }
+    return topplings;
+}
+
+// Снимок байтового поля: вынесенные клетки берутся из копии таблицы
+class LentNarrowGrid : public LentGrid<uint8_t> {
+public:
+    LentNarrowGrid(const BasicGrid<uint8_t>& grid, GridLease<uint8_t>& lease, std::unordered_map<size_t, uint64_t> escapes)
+        : LentGrid<uint8_t>(grid, lease), escapes_(std::move(escapes)) {}
+
+    void readRow(size_t y, uint64_t* out) const override {
+        LentGrid<uint8_t>::readRow(y, out);
+        if (escapes_.empty()) {
+            return;
+        }
+        const uint8_t* cells = row(y);
+        for (size_t x = 0; x < bounds().width(); ++x) {
+            if (cells[x] == NarrowSolver::kEscapeMark) {
+                out[x] = escapes_.at(index(x, y));
+            }
+        }
+    }
+
+private:
+    std::unordered_map<size_t, uint64_t> escapes_;
+};
+
+} // namespace
+
+NarrowSolver::NarrowSolver(const Grid& grid, bool bulk, unsigned threads, const Spare& spare)
+    : current_(makeGrid<uint8_t>(grid.min_x, grid.max_x, grid.min_y, grid.max_y, spare)), bulk_(bulk) {
+    for (size_t y = 0; y < grid.height(); ++y) {
+        for (size_t x = 0; x < grid.width(); ++x) {
+            const uint64_t cell = grid.at(x, y);
+            const size_t index = current_.index(x, y);
+            if (cell >= kEscape) {
+                current_.data[index] = kEscapeMark;
+                escapes_[index] = cell;
+            }
+            else {
+                current_.data[index] = static_cast<uint8_t>(cell);
+            }
+        }
+    }
+    next_ = current_;
+    if (threads != 1) {
+        pool_ = std::make_unique<WorkerPool>(threads);
+    }
+}
+
+uint64_t NarrowSolver::value(size_t index) const {
+    uint8_t cell = current_.data[index];
+    return cell == kEscapeMark ? escapes_.at(index) : cell;
+}
+
+void NarrowSolver::growIfNeeded() {
+    int left, right, top, bottom;
+    if (!unstableSides(current_, left, right, top, bottom)) {
+        return;
+    }
+    if (!growsInPlace(current_, left, right, top, bottom)) {
+        lease_.detach(current_);
+    }
+    GridRemap remap = growGrid(current_, left, right, top, bottom);
+    if (remap.moved) {
+        std::unordered_map<size_t, uint64_t> moved;
+        for (const auto& [index, value] : escapes_) {
+            moved[remap(index)] = value;
+        }
+        escapes_.swap(moved);
+    }
+}
+
+uint64_t NarrowSolver::sweepRows(size_t first, size_t last) {
+    const size_t width = current_.width();
+    const size_t stride = current_.stride();
+    uint64_t toppled = 0;
+    for (size_t y = first; y < last; ++y) {
+        const uint8_t* src = &current_.data[current_.index(0, y)];
+        uint8_t* dst = &next_.data[next_.index(0, y)];
+        toppled += bulk_ ? sweepNarrowRow<true>(src, dst, width, stride) : sweepNarrowRow<false>(src, dst, width, stride);
+    }
+    return toppled;
+}
+
+void NarrowSolver::fixEscapes() {
+    if (escapes_.empty()) {
+        return;
+    }
+    // Вынесенная клетка не бывает на краю: перед проходом поле расширено, поэтому
+    // все ее соседи - клетки поля, а не рамка
+    const size_t stride = current_.stride();
+    touched_.clear();
+    for (const auto& [index, value] : escapes_) {
+        for (size_t cell : { index, index - 1, index + 1, index - stride, index + stride }) {
+            touched_.push_back(cell);
+        }
+    }
+    std::sort(touched_.begin(), touched_.end());
+    touched_.erase(std::unique(touched_.begin(), touched_.end()), touched_.end());
+
+    auto share = [&](size_t index) {
+        uint64_t grains = value(index);
+        return bulk_ ? grains >> 2 : uint64_t(grains >= 4);
+    };
+    // Проход посчитал вынесенные клетки по kEscapeMark, правим на точные значения
+    for (const auto& [index, value] : escapes_) {
+        topplings_ += share(index) - (bulk_ ? kEscapeMark >> 2 : 1);
+    }
+    next_escapes_.clear();
+    for (size_t index : touched_) {
+        uint64_t grains = value(index);
+        uint64_t result = (bulk_ ? grains & 3 : grains - 4 * (grains >= 4))
+            + share(index - 1) + share(index + 1) + share(index - stride) + share(index + stride);
+        if (result >= kEscape) {
+            next_.data[index] = kEscapeMark;
+            next_escapes_[index] = result;
+        }
+        else {
+            next_.data[index] = static_cast<uint8_t>(result);
+        }
+    }
+    escapes_.swap(next_escapes_);
+}
+
+bool NarrowSolver::step() {
+    growIfNeeded();
+    lease_.reclaim(next_);
+    matchLayout(next_, current_);
+
+    const size_t height = current_.height();
+    const uint64_t toppled = pool_ == nullptr
+        ? sweepRows(0, height)
+        : sweepStripes(*pool_, height, SyncSolver::kMinStripeRows, [this](size_t first, size_t last) {
+            return sweepRows(first, last);
+        });
+
+    if (toppled == 0) {
+        return false;
+    }
+    topplings_ += toppled;
+    fixEscapes();
+    std::swap(current_, next_);
+    return true;
+}
+
+void NarrowSolver::readRow(size_t y, uint64_t* out) const {
+    const size_t first = current_.index(0, y);
+    for (size_t x = 0; x < current_.width(); ++x) {
+        out[x] = value(first + x);
+    }
+}
+
+std::unique_ptr<FieldSnapshot> NarrowSolver::snapshot() {
+    // Байтовый буфер отдается как у SyncSolver; копируется только таблица вынесенных клеток
+    if (lease_.busy()) {
+        return SandpileSolver::snapshot();
+    }
+    return std::make_unique<LentNarrowGrid>(current_, lease_, escapes_);
+}
@@ -1,60 +1,147 @@
 #include "sandpile.h"
 #include "grid.h"
+#include "kernel.h"
+#include "narrow.h"
+#include "tiled.h"
+#include "worklist.h"
+#include <algorithm>
+#include <utility>
 #include <vector>
-#include <map>
-
-const std::vector<std::pair<int, int>> directions = { {0, -1}, {0, 1}, {-1, 0}, {1, 0} };
-
-Grid nextIteration(const Grid& grid, bool& hasToppled) {
-    std::map<std::pair<int, int>, uint64_t> temp;
-    hasToppled = false;
-
-    for (int y = 0; y < grid.data.size(); ++y) {
-        for (int x = 0; x < grid.data[y].size(); ++x) {
-            int x_real = grid.min_x + x;
-            int y_real = grid.min_y + y;
-            uint64_t grains = grid.data[y][x];
-            if (grains >= 4) {
-                hasToppled = true;
-                uint64_t remaining = grains - 4;
-                temp[{x_real, y_real}] += remaining;
-                for (const auto& [dx, dy] : directions) {
-                    int nx = x_real + dx;
-                    int ny = y_real + dy;
-                    temp[{nx, ny}]++;
-                }
-            }
-            else {
-                temp[{x_real, y_real}] += grains;
-            }
+
+namespace {
+
+// Копия поля для решателей, которые не умеют отдавать буфер
+class CopiedField : public FieldSnapshot {
+public:
+    explicit CopiedField(const SandpileSolver& solver) : bounds_(solver.bounds()), cells_(bounds_.width() * bounds_.height()) {
+        for (size_t y = 0; y < bounds_.height(); ++y) {
+            solver.readRow(y, &cells_[y * bounds_.width()]);
         }
     }
 
-    if (!hasToppled) return grid;
+    Bounds bounds() const override { return bounds_; }
+    void readRow(size_t y, uint64_t* out) const override {
+        const uint64_t* cells = &cells_[y * bounds_.width()];
+        std::copy(cells, cells + bounds_.width(), out);
+    }
+
+private:
+    Bounds bounds_;
+    std::vector<uint64_t> cells_;
+};
 
-    int new_min_x = grid.min_x, new_max_x = grid.max_x;
-    int new_min_y = grid.min_y, new_max_y = grid.max_y;
-    for (const auto& [coord, _] : temp) {
-        new_min_x = std::min(new_min_x, coord.first);
-        new_max_x = std::max(new_max_x, coord.first);
-        new_min_y = std::min(new_min_y, coord.second);
-        new_max_y = std::max(new_max_y, coord.second);
+} // namespace
+
+std::unique_ptr<FieldSnapshot> SandpileSolver::snapshot() {
+    return std::make_unique<CopiedField>(*this);
+}
+
+SyncSolver::SyncSolver(Grid grid, bool bulk, unsigned threads)
+    : current_(std::move(grid)), next_(current_), bulk_(bulk) {
+    if (threads != 1) {
+        pool_ = std::make_unique<WorkerPool>(threads);
     }
+}
 
-    Grid new_grid;
-    new_grid.min_x = new_min_x;
-    new_grid.max_x = new_max_x;
-    new_grid.min_y = new_min_y;
-    new_grid.max_y = new_max_y;
-    int new_width = new_max_x - new_min_x + 1;
-    int new_height = new_max_y - new_min_y + 1;
-    new_grid.data.resize(new_height, std::vector<uint64_t>(new_width, 0));
+uint64_t SyncSolver::sweepRows(size_t first, size_t last) {
+    const size_t width = current_.width();
+    const size_t stride = current_.stride();
+    uint64_t toppled = 0;
+    for (size_t y = first; y < last; ++y) {
+        const uint64_t* src = &current_.data[current_.index(0, y)];
+        uint64_t* dst = &next_.data[next_.index(0, y)];
+        toppled += bulk_ ? sweepRow<true>(src, dst, width, stride) : sweepRow<false>(src, dst, width, stride);
+    }
+    return toppled;
+}
 
-    for (const auto& [coord, value] : temp) {
-        int x = coord.first - new_grid.min_x;
-        int y = coord.second - new_grid.min_y;
-        new_grid.data[y][x] = value;
+void SyncSolver::growIfNeeded() {
+    int left, right, top, bottom;
+    if (unstableSides(current_, left, right, top, bottom)) {
+        if (!growsInPlace(current_, left, right, top, bottom)) {
+            lease_.detach(current_);
+        }
+        growGrid(current_, left, right, top, bottom);
+    }
+}
+
+bool SyncSolver::step() {
+    // Песчинки, упавшие за границу, попадают в новые клетки: поле расширяется заранее,
+    // и дальше все клетки считаются одинаково
+    growIfNeeded();
+    lease_.reclaim(next_);
+    matchLayout(next_, current_);
+
+    // Полосы читают общее предыдущее поколение и пишут только свои строки нового,
+    // поэтому обмен граничными строками не нужен и результат совпадает с однопоточным
+    const size_t height = current_.height();
+    const uint64_t toppled = pool_ == nullptr
+        ? sweepRows(0, height)
+        : sweepStripes(*pool_, height, kMinStripeRows, [this](size_t first, size_t last) {
+            return sweepRows(first, last);
+        });
+
+    if (toppled == 0) {
+        return false;
     }
+    topplings_ += toppled;
+    std::swap(current_, next_);
+    return true;
+}
+
+namespace {
 
-    return new_grid;
-}
\ No newline at end of file
+// Решатель над полем, запас хранилища которого уже подобран; NarrowSolver
+// строит свое байтовое поле с запасом narrow_spare
+std::unique_ptr<SandpileSolver> solverOver(const Config& config, Grid grid, const Spare& narrow_spare) {
+    if (config.mode == SolverMode::Worklist) {
+        return std::make_unique<WorklistSolver>(std::move(grid), config.bulk);
+    }
+    if (config.mode == SolverMode::Narrow) {
+        return std::make_unique<NarrowSolver>(grid, config.bulk, config.threads, narrow_spare);
+    }
+    if (config.mode == SolverMode::Tiled) {
+        return std::make_unique<TiledSolver>(grid, config.bulk, config.threads);
+    }
+    return std::make_unique<SyncSolver>(std::move(grid), config.bulk, config.threads);
+}
+
+} // namespace
+
+std::unique_ptr<FieldSnapshot> SyncSolver::snapshot() {
+    // Текущее поколение дальше только читается: на следующем шаге из него считается
+    // новое, а потом оно становится вторым буфером, и reclaim() его заменит
+    if (lease_.busy()) {
+        return SandpileSolver::snapshot();
+    }
+    return std::make_unique<LentGrid<uint64_t>>(current_, lease_);
+}
+
+std::unique_ptr<SandpileSolver> makeSolver(const Config& config, Grid grid) {
+    // Готовому полю (например, из контрольной точки) нужен тот же запас, что и начальному.
+    // Плиткам запас не нужен, байтовому полю он положен по ширине его клеток
+    if (config.mode == SolverMode::Tiled) {
+        return solverOver(config, std::move(grid), Spare());
+    }
+    if (config.mode == SolverMode::Narrow) {
+        const Spare spare = predictSpare(grid, sizeof(uint8_t));
+        return solverOver(config, std::move(grid), spare);
+    }
+    const Spare spare = predictSpare(grid);
+    return solverOver(config, reserveSpare(std::move(grid), spare), Spare());
+}
+
+std::unique_ptr<SandpileSolver> makeSolver(const Config& config) {
+    // Разреженному полю плотная сетка не нужна: клетки раскладываются прямо по плиткам
+    if (config.mode == SolverMode::Tiled) {
+        return std::make_unique<TiledSolver>(initialBounds(config), loadSeeds(config), config.bulk, config.threads);
+    }
+    const Bounds bounds = initialBounds(config);
+    const std::vector<Seed> seeds = loadSeeds(config);
+    // Хранилище сразу рассчитано на устойчивое состояние, чтобы поле не росло по ходу расчета.
+    // Широкое поле NarrowSolver только переписывает в байтовое, запас ему не нужен
+    if (config.mode == SolverMode::Narrow) {
+        return solverOver(config, makeInitialGrid(bounds, seeds), predictSpare(bounds, seeds, sizeof(uint8_t)));
+    }
+    return solverOver(config, makeInitialGrid(bounds, seeds, predictSpare(bounds, seeds)), Spare());
+}
@@ -0,0 +1,103 @@
+#include "snapshot.h"
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+SnapshotWriter::SnapshotWriter(unsigned encoders, BmpFormat format, size_t capacity)
+    : format_(format), capacity_(capacity != 0 ? capacity : 2 * std::max(1u, encoders)) {
+    start(encoders);
+}
+
+SnapshotWriter::SnapshotWriter(unsigned encoders, std::unique_ptr<AnimationWriter> animation)
+    : format_(BmpFormat::Palette4), animation_(std::move(animation)), capacity_(2) {
+    start(std::min(encoders, 1u));
+}
+
+void SnapshotWriter::start(unsigned encoders) {
+    for (unsigned i = 0; i < encoders; ++i) {
+        encoders_.emplace_back(&SnapshotWriter::work, this);
+    }
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    not_empty_.notify_all();
+    for (std::thread& encoder : encoders_) {
+        encoder.join();
+    }
+}
+
+std::unique_ptr<SnapshotWriter::Snapshot> SnapshotWriter::acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty()) {
+        return std::make_unique<Snapshot>();
+    }
+    std::unique_ptr<Snapshot> snapshot = std::move(free_.back());
+    free_.pop_back();
+    return snapshot;
+}
+
+void SnapshotWriter::submit(const SandpileSolver& solver, const std::string& path, uint64_t iteration) {
+    std::unique_ptr<Snapshot> snapshot = acquire();
+    snapshot->bounds = solver.bounds();
+    snapshot->path = path;
+    snapshot->iteration = iteration;
+    const size_t width = snapshot->bounds.width();
+    const size_t height = snapshot->bounds.height();
+    snapshot->levels.resize(width * height);
+    row_.resize(width);
+    for (size_t y = 0; y < height; ++y) {
+        solver.readRow(y, row_.data());
+        uint8_t* levels = &snapshot->levels[y * width];
+        for (size_t x = 0; x < width; ++x) {
+            levels[x] = static_cast<uint8_t>(std::min<uint64_t>(row_[x], 4));
+        }
+    }
+
+    if (encoders_.empty()) {
+        encode(*snapshot);
+        free_.push_back(std::move(snapshot));
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return queue_.size() < capacity_; });
+    queue_.push_back(std::move(snapshot));
+    not_empty_.notify_one();
+}
+
+void SnapshotWriter::encode(const Snapshot& snapshot) {
+    const auto started = std::chrono::steady_clock::now();
+    if (animation_ != nullptr) {
+        animation_->append(snapshot.iteration, snapshot.bounds, snapshot.levels);
+    }
+    else {
+        const size_t width = snapshot.bounds.width();
+        LevelReader row = [&](size_t y, uint8_t* out) {
+            const uint8_t* levels = &snapshot.levels[y * width];
+            std::copy(levels, levels + width, out);
+        };
+        saveBMP(snapshot.bounds, row, snapshot.path, format_);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    encode_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), std::memory_order_relaxed);
+}
+
+void SnapshotWriter::work() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        not_empty_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return;
+        }
+        std::unique_ptr<Snapshot> snapshot = std::move(queue_.front());
+        queue_.pop_front();
+        not_full_.notify_one();
+        lock.unlock();
+        encode(*snapshot);
+        lock.lock();
+        free_.push_back(std::move(snapshot));
+    }
+}
@@ -0,0 +1,70 @@
+#include "stats.h"
+#include <iostream>
+
+namespace {
+
+double milliseconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+StatsRecorder::StatsRecorder(const std::string& path, uint64_t freq, AllocationCounter allocations)
+    : file_(path), freq_(freq != 0 ? freq : 1),
+      json_(path.size() >= 6 && path.compare(path.size() - 6, 6, ".jsonl") == 0),
+      allocation_count_(allocations), allocations_(allocationCount()) {
+    if (!file_) {
+        std::cerr << "Cannot open stats file " << path << std::endl;
+        exit(1);
+    }
+    if (!json_) {
+        file_ << "iteration,unstable,min_x,max_x,min_y,max_y,topplings,step_ms,submit_ms,encode_ms,allocations\n";
+    }
+}
+
+void StatsRecorder::record(uint64_t iteration, const SandpileSolver& solver, double encode_seconds, bool last) {
+    if (iteration == recorded_ || (!last && iteration % freq_ != 0)) {
+        return;
+    }
+    recorded_ = iteration;
+
+    const Bounds bounds = solver.bounds();
+    uint64_t unstable = 0;
+    row_.resize(bounds.width());
+    for (size_t y = 0; y < bounds.height(); ++y) {
+        solver.readRow(y, row_.data());
+        for (uint64_t value : row_) {
+            unstable += value >= 4;
+        }
+    }
+    const uint64_t topplings = solver.topplings() - topplings_;
+    const uint64_t allocations = allocationCount() - allocations_;
+    const double step_ms = milliseconds(step_);
+    const double submit_ms = milliseconds(submit_);
+    const double encode_ms = (encode_seconds - encode_seconds_) * 1000;
+
+    if (json_) {
+        file_ << "{\"iteration\":" << iteration << ",\"unstable\":" << unstable
+            << ",\"min_x\":" << bounds.min_x << ",\"max_x\":" << bounds.max_x
+            << ",\"min_y\":" << bounds.min_y << ",\"max_y\":" << bounds.max_y
+            << ",\"topplings\":" << topplings << ",\"step_ms\":" << step_ms
+            << ",\"submit_ms\":" << submit_ms << ",\"encode_ms\":" << encode_ms
+            << ",\"allocations\":" << allocations << "}\n";
+    }
+    else {
+        file_ << iteration << ',' << unstable << ',' << bounds.min_x << ',' << bounds.max_x << ','
+            << bounds.min_y << ',' << bounds.max_y << ',' << topplings << ',' << step_ms << ','
+            << submit_ms << ',' << encode_ms << ',' << allocations << '\n';
+    }
+
+    // Собственные выделения записи (буфер строки) в следующий интервал не попадают
+    topplings_ = solver.topplings();
+    allocations_ = allocationCount();
+    encode_seconds_ = encode_seconds;
+    step_ = Clock::duration::zero();
+    submit_ = Clock::duration::zero();
+}
+
+uint64_t StatsRecorder::allocationCount() const {
+    return allocation_count_ != nullptr ? allocation_count_() : 0;
+}
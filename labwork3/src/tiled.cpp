@@ -0,0 +1,241 @@
+#include "tiled.h"
+#include "grid.h"
+#include "kernel.h"
+#include <algorithm>
+
+namespace {
+
+// Номер плитки, в которую попадает координата; деление с округлением вниз
+int tileOf(int value) {
+    return value >= 0 ? value / TiledSolver::kTile : -((-value + TiledSolver::kTile - 1) / TiledSolver::kTile);
+}
+
+uint64_t tileKey(int tx, int ty) {
+    return (uint64_t(uint32_t(tx)) << 32) | uint32_t(ty);
+}
+
+} // namespace
+
+TiledSolver::TiledSolver(const Bounds& bounds, bool bulk, unsigned threads)
+    : bounds_(bounds), bulk_(bulk) {
+    if (threads != 1) {
+        pool_ = std::make_unique<WorkerPool>(threads);
+    }
+    const size_t workers = pool_ != nullptr ? pool_->size() : 1;
+    scratch_.assign(workers, std::vector<uint64_t>((kTile + 2) * (kTile + 2), 0));
+    toppled_.assign(workers, 0);
+}
+
+TiledSolver::TiledSolver(const Bounds& bounds, const std::vector<Seed>& seeds, bool bulk, unsigned threads)
+    : TiledSolver(bounds, bulk, threads) {
+    for (const Seed& seed : seeds) {
+        place(bounds_.min_x + seed.x, bounds_.min_y + seed.y, seed.value);
+    }
+    activate();
+}
+
+TiledSolver::TiledSolver(const Grid& grid, bool bulk, unsigned threads)
+    : TiledSolver(static_cast<const Bounds&>(grid), bulk, threads) {
+    for (size_t y = 0; y < grid.height(); ++y) {
+        for (size_t x = 0; x < grid.width(); ++x) {
+            if (grid.at(x, y) != 0) {
+                place(grid.min_x + static_cast<int>(x), grid.min_y + static_cast<int>(y), grid.at(x, y));
+            }
+        }
+    }
+    activate();
+}
+
+void TiledSolver::place(int x, int y, uint64_t value) {
+    Tile& target = tile(tileOf(x), tileOf(y));
+    target.now()[(y - target.ty * kTile) * kTile + (x - target.tx * kTile)] = value;
+}
+
+void TiledSolver::activate() {
+    for (auto& [key, entry] : tiles_) {
+        updateFlags(*entry, entry->now());
+        if (entry->unstable) {
+            active_.push_back(entry.get());
+        }
+    }
+}
+
+TiledSolver::Tile* TiledSolver::find(int tx, int ty) const {
+    auto it = tiles_.find(tileKey(tx, ty));
+    return it == tiles_.end() ? nullptr : it->second.get();
+}
+
+TiledSolver::Tile& TiledSolver::tile(int tx, int ty) {
+    std::unique_ptr<Tile>& entry = tiles_[tileKey(tx, ty)];
+    if (entry == nullptr) {
+        entry = std::make_unique<Tile>();
+        entry->tx = tx;
+        entry->ty = ty;
+        for (std::vector<uint64_t>& cells : entry->cells) {
+            cells.assign(kTile * kTile, 0);
+        }
+        const int offsets[4][2] = { { 0, -1 }, { 0, 1 }, { -1, 0 }, { 1, 0 } };
+        for (int side = 0; side < 4; ++side) {
+            Tile* neighbour = find(tx + offsets[side][0], ty + offsets[side][1]);
+            if (neighbour != nullptr) {
+                entry->neighbours[side] = neighbour;
+                neighbour->neighbours[side ^ 1] = entry.get();
+            }
+        }
+    }
+    return *entry;
+}
+
+void TiledSolver::updateFlags(Tile& tile, const uint64_t* cells) {
+    tile.unstable = false;
+    tile.edges = 0;
+    for (int i = 0; i < kTile * kTile; ++i) {
+        tile.unstable |= cells[i] >= 4;
+    }
+    if (!tile.unstable) {
+        return;
+    }
+    for (int i = 0; i < kTile; ++i) {
+        tile.edges |= (cells[i] >= 4 ? kNorth : 0)
+            | (cells[(kTile - 1) * kTile + i] >= 4 ? kSouth : 0)
+            | (cells[i * kTile] >= 4 ? kWest : 0)
+            | (cells[i * kTile + kTile - 1] >= 4 ? kEast : 0);
+    }
+}
+
+void TiledSolver::growBounds() {
+    // Неустойчивые клетки есть только в активных плитках
+    int left = 0, right = 0, top = 0, bottom = 0;
+    for (const Tile* entry : active_) {
+        const int x0 = entry->tx * kTile;
+        const int y0 = entry->ty * kTile;
+        const int first_x = std::max(x0, bounds_.min_x);
+        const int last_x = std::min(x0 + kTile - 1, bounds_.max_x);
+        const int first_y = std::max(y0, bounds_.min_y);
+        const int last_y = std::min(y0 + kTile - 1, bounds_.max_y);
+        const uint64_t* cells = entry->now();
+        auto unstable = [&](int x, int y) { return cells[(y - y0) * kTile + (x - x0)] >= 4; };
+        for (int x = first_x; x <= last_x; ++x) {
+            top |= first_y == bounds_.min_y && unstable(x, first_y);
+            bottom |= last_y == bounds_.max_y && unstable(x, last_y);
+        }
+        for (int y = first_y; y <= last_y; ++y) {
+            left |= first_x == bounds_.min_x && unstable(first_x, y);
+            right |= last_x == bounds_.max_x && unstable(last_x, y);
+        }
+    }
+    bounds_.min_x -= left;
+    bounds_.max_x += right;
+    bounds_.min_y -= top;
+    bounds_.max_y += bottom;
+}
+
+uint64_t TiledSolver::sweepTile(Tile& tile, std::vector<uint64_t>& scratch) const {
+    // Плитка копируется в буфер с рамкой из крайних клеток соседей,
+    // дальше работает тот же проход по строкам, что и в SyncSolver
+    constexpr size_t pitch = kTile + 2;
+    const uint64_t* cells = tile.now();
+    const Tile* north = tile.neighbours[0];
+    const Tile* south = tile.neighbours[1];
+    const Tile* west = tile.neighbours[2];
+    const Tile* east = tile.neighbours[3];
+    for (int x = 0; x < kTile; ++x) {
+        scratch[1 + x] = north != nullptr ? north->now()[(kTile - 1) * kTile + x] : 0;
+        scratch[(kTile + 1) * pitch + 1 + x] = south != nullptr ? south->now()[x] : 0;
+    }
+    for (int y = 0; y < kTile; ++y) {
+        uint64_t* row = &scratch[(y + 1) * pitch];
+        row[0] = west != nullptr ? west->now()[y * kTile + kTile - 1] : 0;
+        std::copy(cells + y * kTile, cells + (y + 1) * kTile, row + 1);
+        row[kTile + 1] = east != nullptr ? east->now()[y * kTile] : 0;
+    }
+
+    uint64_t* next = tile.cells[tile.current ^ 1].data();
+    uint64_t toppled = 0;
+    for (int y = 0; y < kTile; ++y) {
+        const uint64_t* src = &scratch[(y + 1) * pitch + 1];
+        uint64_t* dst = next + y * kTile;
+        toppled += bulk_ ? sweepRow<true>(src, dst, kTile, pitch) : sweepRow<false>(src, dst, kTile, pitch);
+    }
+    return toppled;
+}
+
+bool TiledSolver::step() {
+    if (active_.empty()) {
+        return false;
+    }
+    iteration_++;
+    growBounds();
+
+    // Активные плитки и соседи, в которые осыпаются их края; соседей создаем по требованию
+    work_.clear();
+    auto enlist = [&](Tile& entry) {
+        if (entry.stamp != iteration_) {
+            entry.stamp = iteration_;
+            work_.push_back(&entry);
+        }
+    };
+    for (Tile* entry : active_) {
+        enlist(*entry);
+        const int tx = entry->tx;
+        const int ty = entry->ty;
+        if (entry->edges & kNorth) enlist(tile(tx, ty - 1));
+        if (entry->edges & kSouth) enlist(tile(tx, ty + 1));
+        if (entry->edges & kWest) enlist(tile(tx - 1, ty));
+        if (entry->edges & kEast) enlist(tile(tx + 1, ty));
+    }
+
+    // Плитки пишут только в свой следующий буфер, соседей читают из текущих
+    auto sweep = [this](unsigned worker) {
+        const size_t workers = toppled_.size();
+        const size_t first = work_.size() * worker / workers;
+        const size_t last = work_.size() * (worker + 1) / workers;
+        uint64_t toppled = 0;
+        for (size_t i = first; i < last; ++i) {
+            Tile& entry = *work_[i];
+            toppled += sweepTile(entry, scratch_[worker]);
+            updateFlags(entry, entry.cells[entry.current ^ 1].data());
+        }
+        toppled_[worker] = toppled;
+    };
+    if (pool_ != nullptr) {
+        pool_->run(sweep);
+    }
+    else {
+        sweep(0);
+    }
+
+    active_.clear();
+    for (Tile* entry : work_) {
+        entry->current ^= 1;
+        if (entry->unstable) {
+            active_.push_back(entry);
+        }
+    }
+    uint64_t toppled = 0;
+    for (uint64_t count : toppled_) {
+        toppled += count;
+    }
+    topplings_ += toppled;
+    return toppled != 0;
+}
+
+void TiledSolver::readRow(size_t y, uint64_t* out) const {
+    const int gy = bounds_.min_y + static_cast<int>(y);
+    const int ty = tileOf(gy);
+    int gx = bounds_.min_x;
+    while (gx <= bounds_.max_x) {
+        const int tx = tileOf(gx);
+        const int last = std::min(tx * kTile + kTile - 1, bounds_.max_x);
+        const Tile* entry = find(tx, ty);
+        if (entry != nullptr) {
+            const uint64_t* cells = entry->now() + (gy - ty * kTile) * kTile;
+            std::copy(cells + (gx - tx * kTile), cells + (last - tx * kTile) + 1, out);
+        }
+        else {
+            std::fill(out, out + (last - gx + 1), 0);
+        }
+        out += last - gx + 1;
+        gx = last + 1;
+    }
+}
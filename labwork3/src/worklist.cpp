@@ -0,0 +1,134 @@
+#include "worklist.h"
+#include "grid.h"
+#include <algorithm>
+#include <utility>
+
+WorklistSolver::WorklistSolver(Grid grid, bool bulk) : grid_(std::move(grid)), bulk_(bulk) {
+    resetFlags();
+    for (size_t y = 0; y < grid_.height(); ++y) {
+        for (size_t x = 0; x < grid_.width(); ++x) {
+            if (grid_.at(x, y) >= 4) {
+                push(grid_.index(x, y));
+            }
+        }
+    }
+}
+
+void WorklistSolver::push(size_t index) {
+    if ((flags_[index] & (kQueued | kHalo)) == 0) {
+        flags_[index] |= kQueued;
+        queue_.push_back(index);
+    }
+}
+
+void WorklistSolver::resetFlags() {
+    // Все клетки хранилища вне поля помечены как рамка: в очередь они не попадают
+    flags_.assign(grid_.data.size(), kHalo);
+    for (size_t y = 0; y < grid_.height(); ++y) {
+        std::fill_n(&flags_[grid_.index(0, y)], grid_.width(), 0);
+    }
+    markBorder(kBorder);
+    for (size_t index : queue_) {
+        flags_[index] |= kQueued;
+    }
+}
+
+void WorklistSolver::markBorder(uint8_t flag) {
+    const size_t width = grid_.width();
+    const size_t height = grid_.height();
+    for (size_t x = 0; x < width; ++x) {
+        flags_[grid_.index(x, 0)] = (flags_[grid_.index(x, 0)] & kQueued) | flag;
+        flags_[grid_.index(x, height - 1)] = (flags_[grid_.index(x, height - 1)] & kQueued) | flag;
+    }
+    for (size_t y = 0; y < height; ++y) {
+        flags_[grid_.index(0, y)] = (flags_[grid_.index(0, y)] & kQueued) | flag;
+        flags_[grid_.index(width - 1, y)] = (flags_[grid_.index(width - 1, y)] & kQueued) | flag;
+    }
+}
+
+void WorklistSolver::grow() {
+    const size_t width = grid_.width();
+    const size_t height = grid_.height();
+    const size_t stride = grid_.stride();
+    int left = 0, right = 0, top = 0, bottom = 0;
+    for (size_t x = 0; x < width; ++x) {
+        top |= grid_.data[grid_.index(x, 0) - stride] != 0;
+        bottom |= grid_.data[grid_.index(x, height - 1) + stride] != 0;
+    }
+    for (size_t y = 0; y < height; ++y) {
+        left |= grid_.data[grid_.index(0, y) - 1] != 0;
+        right |= grid_.data[grid_.index(width - 1, y) + 1] != 0;
+    }
+
+    // Старый край перестает быть краем; новый отмечается поверх бывшей рамки
+    markBorder(0);
+    GridRemap remap = growGrid(grid_, left, right, top, bottom);
+    if (remap.moved) {
+        for (size_t& index : queue_) {
+            index = remap(index);
+        }
+        resetFlags();
+    }
+    else {
+        markBorder(kBorder);
+    }
+
+    // Бывшая рамка стала краем поля; перегруженные клетки края ставятся в очередь
+    const size_t grown_width = grid_.width();
+    const size_t grown_height = grid_.height();
+    for (size_t x = 0; x < grown_width; ++x) {
+        if (grid_.at(x, 0) >= 4) push(grid_.index(x, 0));
+        if (grid_.at(x, grown_height - 1) >= 4) push(grid_.index(x, grown_height - 1));
+    }
+    for (size_t y = 0; y < grown_height; ++y) {
+        if (grid_.at(0, y) >= 4) push(grid_.index(0, y));
+        if (grid_.at(grown_width - 1, y) >= 4) push(grid_.index(grown_width - 1, y));
+    }
+    spilled_ = false;
+}
+
+bool WorklistSolver::step() {
+    if (queue_.empty()) {
+        return false;
+    }
+    current_.swap(queue_);
+    queue_.clear();
+    for (size_t index : current_) {
+        flags_[index] &= ~kQueued;
+    }
+
+    uint64_t* data = grid_.data.data();
+    const size_t stride = grid_.stride();
+    bool toppled = false;
+    for (size_t index : current_) {
+        uint64_t value = data[index];
+        if (value < 4) {
+            continue;
+        }
+        toppled = true;
+        uint64_t share = 1;
+        if (bulk_) {
+            share = value >> 2;
+            data[index] = value & 3;
+        }
+        else {
+            data[index] = value - 4;
+            if (value - 4 >= 4) {
+                push(index);
+            }
+        }
+        topplings_ += share;
+        spilled_ |= (flags_[index] & kBorder) != 0;
+        for (size_t neighbour : { index - 1, index + 1, index - stride, index + stride }) {
+            data[neighbour] += share;
+            if (data[neighbour] >= 4) {
+                push(neighbour);
+            }
+        }
+    }
+
+    if (spilled_) {
+        grow();
+    }
+    return toppled;
+}
@@ -0,0 +1,98 @@
+#include "animation.h"
+#include "test_util.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string tempPath(const std::string& name) {
+    return (fs::temp_directory_path() / ("sandpile_test_" + name)).string();
+}
+
+std::vector<uint8_t> levelsOf(const SandpileSolver& solver) {
+    std::vector<uint8_t> levels;
+    for (uint64_t cell : readCells(solver)) {
+        levels.push_back(static_cast<uint8_t>(std::min<uint64_t>(cell, 4)));
+    }
+    return levels;
+}
+
+} // namespace
+
+// Кадров больше kKeyframeInterval, поле растет - проверяются и ключевые, и разностные кадры
+TEST(AnimationTest, WriterReaderRoundTrip) {
+    const std::string path = tempPath("roundtrip.anim");
+    std::vector<AnimationFrame> written;
+    {
+        AnimationWriter writer(path);
+        SyncSolver solver(escapePile());
+        for (uint64_t iteration = 0; solver.step(); ++iteration) {
+            if (iteration % 3 == 0) {
+                AnimationFrame frame;
+                frame.iteration = iteration;
+                frame.bounds = solver.bounds();
+                frame.levels = levelsOf(solver);
+                writer.append(frame.iteration, frame.bounds, frame.levels);
+                written.push_back(std::move(frame));
+            }
+        }
+    }
+    ASSERT_GT(written.size(), AnimationWriter::kKeyframeInterval + 1);
+
+    AnimationReader reader(path);
+    ASSERT_EQ(reader.entries().size(), written.size());
+    for (size_t i = 0; i < written.size(); ++i) {
+        EXPECT_EQ(reader.entries()[i].keyframe, i % AnimationWriter::kKeyframeInterval == 0) << i;
+    }
+    for (size_t i : { size_t(0), size_t(1), AnimationWriter::kKeyframeInterval - 1,
+             AnimationWriter::kKeyframeInterval, written.size() - 1 }) {
+        const AnimationFrame frame = reader.frame(i);
+        EXPECT_EQ(frame.iteration, written[i].iteration) << i;
+        EXPECT_EQ(frame.bounds.min_x, written[i].bounds.min_x) << i;
+        EXPECT_EQ(frame.bounds.max_y, written[i].bounds.max_y) << i;
+        EXPECT_EQ(frame.levels, written[i].levels) << i;
+    }
+    std::remove(path.c_str());
+}
+
+// Недописанный последний кадр пропускается, остальные читаются
+TEST(AnimationTest, TruncatedLastFrameIsSkipped) {
+    const std::string path = tempPath("truncated.anim");
+    {
+        AnimationWriter writer(path);
+        const Bounds bounds = { 0, 3, 0, 1 };
+        writer.append(0, bounds, { 0, 1, 2, 3, 4, 0, 1, 2 });
+        writer.append(1, bounds, { 1, 1, 2, 3, 4, 0, 1, 3 });
+    }
+    fs::resize_file(path, fs::file_size(path) - 1);
+    AnimationReader reader(path);
+    ASSERT_EQ(reader.entries().size(), 1u);
+    EXPECT_EQ(reader.frame(0).levels, std::vector<uint8_t>({ 0, 1, 2, 3, 4, 0, 1, 2 }));
+    std::remove(path.c_str());
+}
+
+// Границы из заголовка на 2^64 клеток не должны доходить до выделения памяти
+TEST(AnimationTest, HugeBoundsAreRejected) {
+    const std::string path = tempPath("huge.anim");
+    {
+        AnimationWriter writer(path);
+        writer.append(0, { 0, 1, 0, 1 }, { 0, 1, 2, 3 });
+    }
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        // min_x, max_x, min_y, max_y первого кадра: магия 8 байт, тип 1, итерация 8
+        const int32_t bounds[4] = { INT32_MIN, INT32_MAX, INT32_MIN, INT32_MAX };
+        file.seekp(8 + 1 + 8);
+        file.write(reinterpret_cast<const char*>(bounds), sizeof(bounds));
+    }
+    EXPECT_EXIT(AnimationReader reader(path), testing::ExitedWithCode(1), "Corrupted animation file");
+    std::remove(path.c_str());
+}
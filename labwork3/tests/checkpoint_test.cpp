@@ -0,0 +1,112 @@
+#include "checkpoint.h"
+#include "test_util.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string tempPath(const std::string& name) {
+    return (fs::temp_directory_path() / ("sandpile_test_" + name)).string();
+}
+
+} // namespace
+
+TEST(CheckpointTest, RoundTripContinuesTheSameRun) {
+    const std::string path = tempPath("roundtrip.chk");
+    SyncSolver solver(escapePile());
+    const uint64_t iteration = 300;
+    for (uint64_t i = 0; i < iteration; ++i) {
+        solver.step();
+    }
+    ASSERT_TRUE(saveCheckpoint(solver, iteration, path));
+
+    Checkpoint checkpoint = loadCheckpoint(path);
+    EXPECT_EQ(checkpoint.iteration, iteration);
+    std::unique_ptr<SandpileSolver> resumed = makeSolver(solverConfig(SolverMode::Sync, false, 1), std::move(checkpoint.grid));
+    ASSERT_EQ(readCells(*resumed), readCells(solver));
+
+    runToStable(solver);
+    runToStable(*resumed);
+    EXPECT_EQ(readCells(*resumed), readCells(solver));
+    std::remove(path.c_str());
+}
+
+TEST(CheckpointTest, WriterKeepsTheLastPoint) {
+    const std::string path = tempPath("writer.chk");
+    std::unique_ptr<SandpileSolver> solver = makeSolver(solverConfig(SolverMode::Tiled, false, 2), escapePile());
+    uint64_t iteration = 0;
+    {
+        CheckpointWriter writer(path);
+        while (solver->step()) {
+            if (iteration % 50 == 0) {
+                writer.submit(*solver, iteration);
+            }
+            iteration++;
+        }
+        writer.finish(*solver, iteration);
+    }
+    Checkpoint checkpoint = loadCheckpoint(path);
+    EXPECT_EQ(checkpoint.iteration, iteration);
+    SyncSolver loaded(std::move(checkpoint.grid));
+    EXPECT_EQ(readCells(loaded), readCells(*solver));
+    EXPECT_FALSE(fs::exists(path + ".tmp"));
+    std::remove(path.c_str());
+}
+
+TEST(CheckpointTest, TruncatedFileIsRejected) {
+    const std::string path = tempPath("truncated.chk");
+    SyncSolver solver(escapePile());
+    ASSERT_TRUE(saveCheckpoint(solver, 0, path));
+    fs::resize_file(path, fs::file_size(path) - 1);
+    EXPECT_EXIT(loadCheckpoint(path), testing::ExitedWithCode(1), "unexpected file size");
+    std::remove(path.c_str());
+}
+
+namespace {
+
+// Большое поле с кучей в середине: копия такого поля в отладочной сборке - десятки миллисекунд,
+// отданный буфер - микросекунды
+Grid largePile() {
+    Grid grid = makeGrid(0, 2047, 0, 2047);
+    grid.at(1024, 1024) = 100000;
+    grid.at(1000, 1030) = 5000;
+    return grid;
+}
+
+} // namespace
+
+// submit() не копирует поле на потоке расчета, а решатель, пока точка пишется,
+// не портит отданный буфер
+TEST(CheckpointTest, SubmitDoesNotPauseTheSolver) {
+    for (SolverMode mode : { SolverMode::Sync, SolverMode::Narrow }) {
+        const std::string path = tempPath("submit.chk");
+        std::unique_ptr<SandpileSolver> solver = makeSolver(solverConfig(mode, false, 1), largePile());
+        solver->step();
+        const std::vector<uint64_t> submitted = readCells(*solver);
+        const Bounds bounds = solver->bounds();
+        {
+            CheckpointWriter writer(path);
+            const auto started = std::chrono::steady_clock::now();
+            ASSERT_TRUE(writer.submit(*solver, 1));
+            const auto elapsed = std::chrono::steady_clock::now() - started;
+            EXPECT_LT(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(), 20000);
+            for (int i = 0; i < 4; ++i) {
+                solver->step();
+            }
+        }
+        Checkpoint checkpoint = loadCheckpoint(path);
+        EXPECT_EQ(checkpoint.iteration, 1u);
+        EXPECT_EQ(checkpoint.grid.min_x, bounds.min_x);
+        EXPECT_EQ(checkpoint.grid.max_y, bounds.max_y);
+        SyncSolver loaded(std::move(checkpoint.grid));
+        EXPECT_EQ(readCells(loaded), submitted);
+        std::remove(path.c_str());
+    }
+}
@@ -0,0 +1,89 @@
+#include "grid.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+bool allZero(const Grid& grid) {
+    return std::all_of(grid.data.begin(), grid.data.end(), [](uint64_t cell) { return cell == 0; });
+}
+
+} // namespace
+
+// Рост в запас на месте: клетки второго буфера остаются где были
+TEST(GridTest, MatchLayoutKeepsCellsAfterGrowthInPlace) {
+    Spare spare;
+    spare.left = spare.right = spare.top = spare.bottom = 4;
+    Grid source = makeGrid(0, 3, 0, 3, spare);
+    Grid target = source;
+    target.at(1, 2) = 7;
+
+    growGrid(source, 1, 1, 1, 1);
+    matchLayout(target, source);
+    EXPECT_EQ(target.origin, source.origin);
+    EXPECT_EQ(target.at(2, 3), 7u);
+}
+
+// Новое хранилище того же размера и с той же длиной строки, но с другим началом поля:
+// старые клетки оказались бы не на своих местах, поэтому буфер обнуляется
+TEST(GridTest, MatchLayoutClearsMovedStorageOfTheSameSize) {
+    Spare spare;
+    spare.left = spare.right = spare.top = spare.bottom = 4;
+    Grid source = makeGrid(0, 3, 0, 3, spare);
+    Grid target = source;
+    target.at(1, 2) = 7;
+
+    source.origin += source.pitch + 1;
+    ASSERT_EQ(source.data.size(), target.data.size());
+    matchLayout(target, source);
+    EXPECT_TRUE(allZero(target));
+}
+
+TEST(GridTest, MatchLayoutClearsAfterReallocation) {
+    Grid source = makeGrid(0, 3, 0, 3);
+    Grid target = source;
+    target.at(0, 0) = 5;
+
+    const GridRemap remap = growGrid(source, 1, 0, 1, 0);
+    ASSERT_TRUE(remap.moved);
+    matchLayout(target, source);
+    EXPECT_TRUE(allZero(target));
+}
+
+namespace {
+
+// Число клеток хранилища с запасом spare вокруг поля bounds
+double storageCells(const Bounds& bounds, const Spare& spare) {
+    return double(bounds.width() + 2 + spare.left + spare.right) * double(bounds.height() + 2 + spare.top + spare.bottom);
+}
+
+} // namespace
+
+// Запас огромной кучи ограничен по памяти, а не по числу клеток: байтовым клеткам его больше
+TEST(GridTest, PredictedSpareIsCappedByCellWidth) {
+    const Bounds bounds{ 0, 99, 0, 99 };
+    const std::vector<Seed> seeds{ { 50, 50, uint64_t(1) << 40 } };
+    const Spare wide = predictSpare(bounds, seeds);
+    const Spare narrow = predictSpare(bounds, seeds, sizeof(uint8_t));
+    const double kMaxBytes = double(uint64_t(1) << 31);
+    EXPECT_LE(storageCells(bounds, wide) * sizeof(uint64_t), kMaxBytes * 1.01);
+    EXPECT_LE(storageCells(bounds, narrow) * sizeof(uint8_t), kMaxBytes * 1.01);
+    EXPECT_GT(storageCells(bounds, narrow), 7 * storageCells(bounds, wide));
+}
+
+// Готовое поле (как из контрольной точки) получает тот же запас, что и поле из начальных клеток
+TEST(GridTest, ReservedSpareMatchesInitialGrid) {
+    const Bounds bounds{ 0, 20, 0, 20 };
+    const std::vector<Seed> seeds{ { 10, 10, 4000 }, { 2, 3, 240 } };
+    const Spare expected = predictSpare(bounds, seeds);
+    const Grid grid = reserveSpare(makeInitialGrid(bounds, seeds), predictSpare(makeInitialGrid(bounds, seeds)));
+    const Grid initial = makeInitialGrid(bounds, seeds, expected);
+    EXPECT_EQ(grid.pitch, initial.pitch);
+    EXPECT_EQ(grid.origin, initial.origin);
+    EXPECT_EQ(grid.data, initial.data);
+    // Запаса хватает - поле не копируется
+    const Grid again = reserveSpare(grid, predictSpare(grid));
+    EXPECT_EQ(again.data.size(), grid.data.size());
+}
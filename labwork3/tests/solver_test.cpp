@@ -0,0 +1,71 @@
+#include "test_util.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct SolverCase {
+    SolverMode mode;
+    bool bulk;
+    unsigned threads;
+    const char* name;
+};
+
+const SolverCase kCases[] = {
+    { SolverMode::Sync, false, 1, "sync" },
+    { SolverMode::Sync, true, 1, "sync bulk" },
+    { SolverMode::Sync, false, 3, "sync 3 threads" },
+    { SolverMode::Narrow, false, 1, "narrow" },
+    { SolverMode::Narrow, true, 1, "narrow bulk" },
+    { SolverMode::Narrow, true, 3, "narrow bulk 3 threads" },
+    { SolverMode::Tiled, false, 1, "tiled" },
+    { SolverMode::Tiled, true, 1, "tiled bulk" },
+    { SolverMode::Tiled, false, 3, "tiled 3 threads" },
+    { SolverMode::Worklist, false, 1, "worklist" },
+    { SolverMode::Worklist, true, 1, "worklist bulk" },
+};
+
+} // namespace
+
+// Устойчивое состояние и число обвалов не зависят от порядка обвалов,
+// поэтому все режимы обязаны совпасть с простым синхронным
+TEST(SolverTest, ModesReachTheSameStableState) {
+    SyncSolver reference(escapePile());
+    runToStable(reference);
+    const Bounds expected_bounds = reference.bounds();
+    const std::vector<uint64_t> expected = readCells(reference);
+    ASSERT_GT(reference.topplings(), 0u);
+
+    for (const SolverCase& test : kCases) {
+        std::unique_ptr<SandpileSolver> solver = makeSolver(solverConfig(test.mode, test.bulk, test.threads), escapePile());
+        runToStable(*solver);
+        const Bounds bounds = solver->bounds();
+        EXPECT_EQ(bounds.min_x, expected_bounds.min_x) << test.name;
+        EXPECT_EQ(bounds.max_x, expected_bounds.max_x) << test.name;
+        EXPECT_EQ(bounds.min_y, expected_bounds.min_y) << test.name;
+        EXPECT_EQ(bounds.max_y, expected_bounds.max_y) << test.name;
+        EXPECT_EQ(readCells(*solver), expected) << test.name;
+        EXPECT_EQ(solver->topplings(), reference.topplings()) << test.name;
+    }
+}
+
+// Без bulk каждая итерация одинакова во всех синхронных режимах, не только последняя
+TEST(SolverTest, SynchronousModesAgreeOnEveryIteration) {
+    SyncSolver reference(escapePile());
+    std::unique_ptr<SandpileSolver> narrow = makeSolver(solverConfig(SolverMode::Narrow, false, 1), escapePile());
+    std::unique_ptr<SandpileSolver> tiled = makeSolver(solverConfig(SolverMode::Tiled, false, 1), escapePile());
+    bool stable = false;
+    for (uint64_t iteration = 0; !stable; ++iteration) {
+        stable = !reference.step();
+        ASSERT_EQ(narrow->step(), !stable) << iteration;
+        ASSERT_EQ(tiled->step(), !stable) << iteration;
+        if (iteration % 97 == 0 || stable) {
+            const std::vector<uint64_t> expected = readCells(reference);
+            ASSERT_EQ(readCells(*narrow), expected) << iteration;
+            ASSERT_EQ(readCells(*tiled), expected) << iteration;
+            ASSERT_EQ(narrow->topplings(), reference.topplings()) << iteration;
+            ASSERT_EQ(tiled->topplings(), reference.topplings()) << iteration;
+        }
+    }
+}
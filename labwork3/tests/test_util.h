@@ -0,0 +1,43 @@
+#pragma once
+#include "sandpile.h"
+#include <cstdint>
+#include <vector>
+
+// Все клетки поля решателя по строкам
+inline std::vector<uint64_t> readCells(const SandpileSolver& solver) {
+    const Bounds bounds = solver.bounds();
+    std::vector<uint64_t> cells(bounds.width() * bounds.height());
+    for (size_t y = 0; y < bounds.height(); ++y) {
+        solver.readRow(y, &cells[y * bounds.width()]);
+    }
+    return cells;
+}
+
+// Считает до устойчивого состояния; число итераций
+inline uint64_t runToStable(SandpileSolver& solver) {
+    uint64_t iterations = 0;
+    while (solver.step()) {
+        iterations++;
+    }
+    return iterations;
+}
+
+inline Config solverConfig(SolverMode mode, bool bulk, unsigned threads) {
+    Config config{};
+    config.mode = mode;
+    config.bulk = bulk;
+    config.threads = threads;
+    return config;
+}
+
+// Куча в центре и несколько клеток выше порога вылета байтовой клетки (240 песчинок),
+// чтобы NarrowSolver прошел и через вылеты
+inline Grid escapePile() {
+    Grid grid = makeGrid(0, 20, 0, 20);
+    grid.at(10, 10) = 4000;
+    grid.at(2, 3) = 240;
+    grid.at(17, 5) = 1000;
+    grid.at(15, 18) = 300;
+    grid.at(4, 16) = 255;
+    return grid;
+}
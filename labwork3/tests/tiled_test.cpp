@@ -0,0 +1,31 @@
+#include "test_util.h"
+#include "tiled.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+// Разреженные кучи далеко друг от друга: плитки создаются только там, где есть песок
+TEST(TiledTest, FromSeedsMatchesSync) {
+    const Bounds bounds = { 0, 511, 0, 383 };
+    const std::vector<Seed> seeds = {
+        { 3, 5, 700 },
+        { 500, 10, 300 },
+        { 250, 200, 3000 },
+        { 17, 380, 241 },
+        { 510, 382, 4 },
+    };
+    Grid grid = makeGrid(bounds.min_x, bounds.max_x, bounds.min_y, bounds.max_y);
+    for (const Seed& seed : seeds) {
+        grid.at(seed.x, seed.y) = seed.value;
+    }
+
+    for (bool bulk : { false, true }) {
+        SyncSolver reference(grid, bulk);
+        runToStable(reference);
+        TiledSolver tiled(bounds, seeds, bulk, 2);
+        runToStable(tiled);
+        EXPECT_EQ(readCells(tiled), readCells(reference)) << bulk;
+        EXPECT_EQ(tiled.topplings(), reference.topplings()) << bulk;
+        // Занятая площадь много меньше поля 512 x 384
+        EXPECT_LT(tiled.tileCount(), size_t(512 / TiledSolver::kTile) * (384 / TiledSolver::kTile) / 2) << bulk;
+    }
+}